@@ -1130,6 +1130,16 @@ static bool ix86_skip_instruction(SIGSEGV_REGISTER_TYPE * regs)
 		  do_mov_extend:
 			op_len = 2;
 			goto do_transfer_load;
+		case 0x38:
+			switch (eip[2]) {
+			case 0xf0: // MOVBE r32, m32 (or 16/64-bit operation)
+				op_len = 3;
+				goto do_transfer_load;
+			case 0xf1: // MOVBE m32, r32 (or 16/64-bit operation)
+				op_len = 3;
+				goto do_transfer_store;
+			}
+			break;
 		}
 		break;
 #if defined(__x86_64__) || defined(_M_X64)
@@ -3321,6 +3331,14 @@ static bool arch_insn_skipper_tests()
 		0x8b, 0x0c, 0x18,              // mov    (%eax,%ebx,1),%ecx
 		0x89, 0x00,                    // mov    %eax,(%eax)
 		0x89, 0x0c, 0x18,              // mov    %ecx,(%eax,%ebx,1)
+		0x0f, 0x38, 0xf0, 0x00,        // movbe  (%eax),%eax
+		0x0f, 0x38, 0xf0, 0x0c, 0x18,  // movbe  (%eax,%ebx,1),%ecx
+		0x0f, 0x38, 0xf1, 0x00,        // movbe  %eax,(%eax)
+		0x0f, 0x38, 0xf1, 0x0c, 0x18,  // movbe  %ecx,(%eax,%ebx,1)
+		0x66, 0x0f, 0x38, 0xf0, 0x00,  // movbe  (%eax),%ax
+		0x66, 0x0f, 0x38, 0xf1, 0x0c, 0x18, // movbe %cx,(%eax,%ebx,1)
+		0x0f, 0x38, 0xf0, 0x97, 0x78, 0x56, 0x34, 0x12, // movbe 0x12345678(%edi),%edx
+		0x0f, 0x38, 0xf1, 0x57, 0xf8,  // movbe  %edx,-0x8(%edi)
 #if defined(x86_64) || defined(__x86_64__) || defined(_M_X64)
 		0x44, 0x8a, 0x00,              // mov    (%rax),%r8b
 		0x44, 0x8a, 0x20,              // mov    (%rax),%r12b
@@ -3346,6 +3364,10 @@ static bool arch_insn_skipper_tests()
 		0x4e, 0x89, 0x1c, 0x10,        // mov    %r11,(%rax,%r10,1)
 		0x63, 0x47, 0x04,              // movslq 4(%rdi),%eax
 		0x48, 0x63, 0x47, 0x04,        // movslq 4(%rdi),%rax
+		0x44, 0x0f, 0x38, 0xf0, 0x00,  // movbe  (%rax),%r8d
+		0x48, 0x0f, 0x38, 0xf0, 0x08,  // movbe  (%rax),%rcx
+		0x4e, 0x0f, 0x38, 0xf1, 0x1c, 0x10, // movbe %r11,(%rax,%r10,1)
+		0x66, 0x44, 0x0f, 0x38, 0xf1, 0x00, // movbe %r8w,(%rax)
 #endif
 		0                              // end
 	};
@@ -0,0 +1,163 @@
+/*
+ *  video_tiles.h - Video/graphics emulation, tiled change detection
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef VIDEO_TILES_H
+#define VIDEO_TILES_H
+
+// Note: this file is #include'd in the static refresh code of video_x.cpp and video_sdl*.cpp
+
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Size of change detection tiles, in pixels, wider screens use wider tiles
+const uint32 VIDEO_TILE_SIZE = 32;
+const uint32 VIDEO_MAX_TILES_X = 128;
+
+// Maximum number of dirty rectangles, further changes are merged into
+// the bounding box of all of them
+const int VIDEO_MAX_DIRTY_RECTS = 64;
+
+// Dirty rectangle, in pixels
+struct video_dirty_rect {
+	uint32 x, y, w, h;
+};
+
+// Statistics of the static display update
+struct video_refresh_stats {
+	uint32 frames;				// Number of updates with changes
+	uint32 rects;				// Number of dirty rectangles
+	uint64 scan_time;			// Time spent finding and copying changes (usec)
+	uint64 upload_time;			// Time spent uploading changes to the display (usec)
+};
+
+// Check whether SIZE bytes differ between P and P2
+static inline bool video_bytes_changed(const uint8 *p, const uint8 *p2, uint32 size)
+{
+	uint32 i = 0;
+#if defined(__SSE2__)
+	if (size >= 16) {
+		__m128i d = _mm_setzero_si128();
+		for (; i + 16 <= size; i += 16) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)(p + i));
+			const __m128i b = _mm_loadu_si128((const __m128i *)(p2 + i));
+			d = _mm_or_si128(d, _mm_xor_si128(a, b));
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(d, _mm_setzero_si128())) != 0xffff)
+			return true;
+	}
+#endif
+	return i < size && memcmp(p + i, p2 + i, size - i) != 0;
+}
+
+// Add a dirty rectangle, merging it with the one right above it if they
+// have the same columns
+static void video_add_dirty_rect(video_dirty_rect *rects, int &n_rects, uint32 x, uint32 y, uint32 w, uint32 h)
+{
+	for (int i = 0; i < n_rects; i++) {
+		video_dirty_rect &r = rects[i];
+		if (r.x == x && r.w == w && r.y + r.h == y) {
+			r.h += h;
+			return;
+		}
+	}
+
+	if (n_rects < VIDEO_MAX_DIRTY_RECTS) {
+		video_dirty_rect &r = rects[n_rects++];
+		r.x = x;
+		r.y = y;
+		r.w = w;
+		r.h = h;
+		return;
+	}
+
+	// Too many rectangles, keep their bounding box only
+	uint32 x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+	for (int i = 0; i < n_rects; i++) {
+		const video_dirty_rect &r = rects[i];
+		if (r.x < x1) x1 = r.x;
+		if (r.y < y1) y1 = r.y;
+		if (r.x + r.w > x2) x2 = r.x + r.w;
+		if (r.y + r.h > y2) y2 = r.y + r.h;
+	}
+	rects[0].x = x1;
+	rects[0].y = y1;
+	rects[0].w = x2 - x1;
+	rects[0].h = y2 - y1;
+	n_rects = 1;
+}
+
+// Find the tiles that differ between BUFFER and COPY. Horizontal runs of
+// dirty tiles are merged into rectangles, RECTS must hold at least
+// VIDEO_MAX_DIRTY_RECTS entries. Returns the number of rectangles
+static int video_find_dirty_rects(const uint8 *buffer, const uint8 *copy, uint32 width, uint32 height,
+								  uint32 bits_per_pixel, uint32 bytes_per_row, video_dirty_rect *rects)
+{
+	uint32 tile_size = VIDEO_TILE_SIZE;
+	while (width > tile_size * VIDEO_MAX_TILES_X)
+		tile_size *= 2;
+	const uint32 n_tiles = (width + tile_size - 1) / tile_size;
+	const uint32 row_size = (width * bits_per_pixel + 7) / 8;
+
+	int n_rects = 0;
+	bool dirty[VIDEO_MAX_TILES_X];
+	for (uint32 y = 0; y < height; y += tile_size) {
+		const uint32 h = height - y < tile_size ? height - y : tile_size;
+
+		// Rows are scanned whole first, since most of them don't change
+		bool row_dirty = false;
+		for (uint32 j = y; j < y + h; j++) {
+			const uint8 *p = buffer + j * bytes_per_row;
+			const uint8 *p2 = copy + j * bytes_per_row;
+			if (memcmp(p, p2, row_size) == 0)
+				continue;
+			if (!row_dirty) {
+				memset(dirty, 0, sizeof(dirty));
+				row_dirty = true;
+			}
+			for (uint32 t = 0; t < n_tiles; t++) {
+				if (dirty[t])
+					continue;
+				const uint32 xb = t * tile_size * bits_per_pixel / 8;
+				const uint32 xe = (t + 1) * tile_size * bits_per_pixel / 8;
+				dirty[t] = video_bytes_changed(p + xb, p2 + xb, (xe < row_size ? xe : row_size) - xb);
+			}
+		}
+		if (!row_dirty)
+			continue;
+
+		// Merge runs of dirty tiles
+		for (uint32 t = 0; t < n_tiles; ) {
+			if (!dirty[t]) {
+				t++;
+				continue;
+			}
+			const uint32 x = t * tile_size;
+			while (t < n_tiles && dirty[t])
+				t++;
+			const uint32 x2 = t * tile_size < width ? t * tile_size : width;
+			video_add_dirty_rect(rects, n_rects, x, y, x2 - x, h);
+		}
+	}
+	return n_rects;
+}
+
+#endif /* VIDEO_TILES_H */
@@ -38,6 +38,8 @@ prefs_desc platform_prefs_items[] = {
 	{"ignoresegv", TYPE_BOOLEAN, false,    "ignore illegal memory accesses"},
 #endif
 	{"idlewait", TYPE_BOOLEAN, false,      "sleep when idle"},
+	{"sparsebundlebands", TYPE_INT32, false, "number of band files kept open per sparse bundle disk"},
+	{"diskcache", TYPE_INT32, false,       "size of block cache per disk image in KB (0 = off)"},
 	{NULL, TYPE_END, false, NULL} // End of list
 };
 
@@ -0,0 +1,121 @@
+/*
+ *  audio_mix.h - Sample conversion and mixing kernels
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AUDIO_MIX_H
+#define AUDIO_MIX_H
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Duplicate each byte of src, turning 8 bit mono into stereo (len = output bytes)
+static inline void expand_mono_u8(uint8 *dst, const uint8 *src, int len)
+{
+	int i = 0;
+#if defined(__SSE2__)
+	for (; i + 32 <= len; i += 32) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i / 2));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(s, s));
+		_mm_storeu_si128((__m128i *)(dst + i + 16), _mm_unpackhi_epi8(s, s));
+	}
+#endif
+	for (; i < len; i += 2)
+		dst[i] = dst[i + 1] = src[i >> 1];
+}
+
+// Mix two sources into dst in one pass, dst = a * vol_a + b * vol_b, with
+// volumes in SDL_MIX_MAXVOLUME units; a source with volume 0 is ignored but
+// must still be readable. The scalar versions also handle the samples left
+// over by the SSE2 loops
+static inline void mix_s16msb_scalar(uint8 *dst, const uint8 *a, int vol_a, const uint8 *b, int vol_b, int len)
+{
+	for (int i = 0; i + 2 <= len; i += 2) {
+		int sa = (int16)((a[i] << 8) | a[i + 1]);
+		int sb = (int16)((b[i] << 8) | b[i + 1]);
+		int d = (sa * vol_a + sb * vol_b) >> 7;
+		if (d > 32767)
+			d = 32767;
+		else if (d < -32768)
+			d = -32768;
+		dst[i] = d >> 8;
+		dst[i + 1] = d;
+	}
+}
+
+static inline void mix_u8_scalar(uint8 *dst, const uint8 *a, int vol_a, const uint8 *b, int vol_b, int len)
+{
+	for (int i = 0; i < len; i++) {
+		int d = ((a[i] - 0x80) * vol_a + (b[i] - 0x80) * vol_b) >> 7;
+		if (d > 127)
+			d = 127;
+		else if (d < -128)
+			d = -128;
+		dst[i] = d + 0x80;
+	}
+}
+
+static inline void mix_s16msb(uint8 *dst, const uint8 *a, int vol_a, const uint8 *b, int vol_b, int len)
+{
+	int i = 0;
+#if defined(__SSE2__)
+	// Interleave samples of a and b, so one madd scales and sums them
+	const __m128i vol = _mm_set1_epi32((vol_b << 16) | vol_a);
+	for (; i + 16 <= len; i += 16) {
+		__m128i sa = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i sb = _mm_loadu_si128((const __m128i *)(b + i));
+		sa = _mm_or_si128(_mm_slli_epi16(sa, 8), _mm_srli_epi16(sa, 8));
+		sb = _mm_or_si128(_mm_slli_epi16(sb, 8), _mm_srli_epi16(sb, 8));
+		__m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(sa, sb), vol), 7);
+		__m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(sa, sb), vol), 7);
+		__m128i d = _mm_packs_epi32(lo, hi);
+		d = _mm_or_si128(_mm_slli_epi16(d, 8), _mm_srli_epi16(d, 8));
+		_mm_storeu_si128((__m128i *)(dst + i), d);
+	}
+#endif
+	mix_s16msb_scalar(dst + i, a + i, vol_a, b + i, vol_b, len - i);
+}
+
+static inline void mix_u8(uint8 *dst, const uint8 *a, int vol_a, const uint8 *b, int vol_b, int len)
+{
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128i vol = _mm_set1_epi32((vol_b << 16) | vol_a);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias16 = _mm_set1_epi16(0x80);
+	const __m128i bias8 = _mm_set1_epi8((char)0x80);
+	for (; i + 16 <= len; i += 16) {
+		__m128i sa = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i sb = _mm_loadu_si128((const __m128i *)(b + i));
+		__m128i sa_lo = _mm_sub_epi16(_mm_unpacklo_epi8(sa, zero), bias16);
+		__m128i sa_hi = _mm_sub_epi16(_mm_unpackhi_epi8(sa, zero), bias16);
+		__m128i sb_lo = _mm_sub_epi16(_mm_unpacklo_epi8(sb, zero), bias16);
+		__m128i sb_hi = _mm_sub_epi16(_mm_unpackhi_epi8(sb, zero), bias16);
+		__m128i d0 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(sa_lo, sb_lo), vol), 7);
+		__m128i d1 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(sa_lo, sb_lo), vol), 7);
+		__m128i d2 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(sa_hi, sb_hi), vol), 7);
+		__m128i d3 = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(sa_hi, sb_hi), vol), 7);
+		__m128i d = _mm_packs_epi16(_mm_packs_epi32(d0, d1), _mm_packs_epi32(d2, d3));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(d, bias8));
+	}
+#endif
+	mix_u8_scalar(dst + i, a + i, vol_a, b + i, vol_b, len - i);
+}
+
+#endif
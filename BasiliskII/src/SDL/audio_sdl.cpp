@@ -37,6 +37,8 @@
 #include "bincue.h"
 #endif
 
+#include "audio_mix.h"
+
 
 #define MAC_MAX_VOLUME 0x0100
 
@@ -46,14 +48,24 @@ static int audio_sample_size_index = 0;
 static int audio_channel_count_index = 0;
 
 // Global variables
-static SDL_sem *audio_irq_done_sem = NULL;			// Signal from interrupt to streaming thread: data block read
-static uint8 silence_byte;							// Byte value to use to fill sound buffers with silence
-static uint8 *audio_mix_buf = NULL;
+static uint8 *audio_conv_buf = NULL;				// Buffer for converting data in AudioInterrupt()
+static uint8 *audio_cd_buf = NULL;					// Buffer for CD audio to be mixed in
+static bool audio_format_u8;						// Flag: output format is AUDIO_U8, else AUDIO_S16MSB
+static int audio_block_size;						// Size of one audio block in bytes
 static int main_volume = MAC_MAX_VOLUME;
 static int speaker_volume = MAC_MAX_VOLUME;
 static bool main_mute = false;
 static bool speaker_mute = false;
 
+// Ring buffer of audio data, filled by AudioInterrupt() ahead of the streaming function
+static uint8 *audio_ring = NULL;
+static uint32 audio_ring_size;						// Size of ring buffer in bytes (power of 2)
+static uint32 audio_ring_target;					// Number of bytes to keep buffered
+static volatile uint32 audio_ring_head = 0;			// Write position (AudioInterrupt)
+static volatile uint32 audio_ring_tail = 0;			// Read position (streaming function)
+static volatile int audio_irq_pending = 0;			// Flag: audio interrupt triggered, not yet handled
+static uint32 audio_underruns = 0;					// Number of streaming function calls short of data
+
 // Prototypes
 static void stream_func(void *arg, uint8 *stream, int stream_len);
 static int get_audio_volume();
@@ -125,12 +137,26 @@ static bool open_sdl_audio(void)
 	SDL_AudioDriverName(driver_name, sizeof(driver_name) - 1);
 #endif
 	printf("Using SDL/%s audio output\n", driver_name ? driver_name : "");
-	silence_byte = audio_spec.silence;
-	SDL_PauseAudio(0);
 
 	// Sound buffer size = 4096 frames
 	audio_frames_per_block = audio_spec.samples;
-	audio_mix_buf = (uint8*)malloc(audio_spec.size);
+	audio_block_size = audio_spec.size;
+	audio_format_u8 = (audio_spec.format == AUDIO_U8);
+	audio_conv_buf = (uint8*)malloc(audio_spec.size);
+	audio_cd_buf = (uint8*)malloc(audio_spec.size);
+
+	// Ring buffer holds "sound_latency" blocks, plus one being written
+	int latency = PrefsFindInt32("sound_latency");
+	if (latency < 1)
+		latency = 1;
+	audio_ring_target = latency * audio_spec.size;
+	audio_ring_size = 1;
+	while (audio_ring_size < audio_ring_target + audio_spec.size)
+		audio_ring_size <<= 1;
+	audio_ring = (uint8 *)malloc(audio_ring_size);
+	audio_ring_head = audio_ring_tail = 0;
+	audio_irq_pending = 0;
+	SDL_PauseAudio(0);
 	return true;
 }
 
@@ -164,8 +190,6 @@ void AudioInit(void)
 	if (PrefsFindBool("nosound"))
 		return;
 
-	// Init semaphore
-	audio_irq_done_sem = SDL_CreateSemaphore(0);
 #ifdef BINCUE
 	InitBinCue();
 #endif
@@ -185,8 +209,12 @@ static void close_audio(void)
 	CloseAudio_bincue();
 #endif
 	SDL_CloseAudio();
-	free(audio_mix_buf);
-	audio_mix_buf = NULL;
+	free(audio_conv_buf);
+	audio_conv_buf = NULL;
+	free(audio_cd_buf);
+	audio_cd_buf = NULL;
+	free(audio_ring);
+	audio_ring = NULL;
 	audio_open = false;
 }
 
@@ -197,9 +225,7 @@ void AudioExit(void)
 #ifdef BINCUE
 	ExitBinCue();
 #endif
-	// Delete semaphore
-	if (audio_irq_done_sem)
-		SDL_DestroySemaphore(audio_irq_done_sem);
+	D(bug("%u audio underruns\n", audio_underruns));
 }
 
 
@@ -222,80 +248,150 @@ void audio_exit_stream()
 
 
 /*
- *  Streaming function
+ *  Sample conversion and mixing
  */
 
-static void stream_func(void *arg, uint8 *stream, int stream_len)
+static inline void mix_audio(uint8 *dst, const uint8 *a, int vol_a, const uint8 *b, int vol_b, int len)
 {
-	if (AudioStatus.num_sources) {
-		// Trigger audio interrupt to get new buffer
+	if (audio_format_u8)
+		mix_u8(dst, a, vol_a, b, vol_b, len);
+	else
+		mix_s16msb(dst, a, vol_a, b, vol_b, len);
+}
+
+
+/*
+ *  Audio ring buffer
+ */
+
+static inline uint32 audio_ring_fill(void)
+{
+	return __atomic_load_n(&audio_ring_head, __ATOMIC_ACQUIRE) - audio_ring_tail;
+}
+
+// Copy data into ring buffer (emulation thread)
+static void audio_ring_write(const uint8 *src, uint32 size)
+{
+	uint32 head = audio_ring_head;
+	uint32 pos = head & (audio_ring_size - 1);
+	uint32 n = audio_ring_size - pos;
+	if (n > size)
+		n = size;
+	memcpy(audio_ring + pos, src, n);
+	memcpy(audio_ring, src + n, size - n);
+	__atomic_store_n(&audio_ring_head, head + size, __ATOMIC_RELEASE);
+}
+
+// Mix data out of ring buffer together with b (streaming thread)
+static void audio_ring_mix(uint8 *dst, uint32 size, int vol, const uint8 *b, int vol_b)
+{
+	uint32 tail = audio_ring_tail;
+	uint32 pos = tail & (audio_ring_size - 1);
+	uint32 n = audio_ring_size - pos;
+	if (n > size)
+		n = size;
+	mix_audio(dst, audio_ring + pos, vol, b, vol_b, n);
+	mix_audio(dst + n, audio_ring, vol, b + n, vol_b, size - n);
+	__atomic_store_n(&audio_ring_tail, tail + size, __ATOMIC_RELEASE);
+}
+
+// Ask the emulation thread for more data, unless a request is already pending
+static void audio_request_data(void)
+{
+	if (__atomic_exchange_n(&audio_irq_pending, 1, __ATOMIC_ACQ_REL) == 0) {
 		D(bug("stream: triggering irq\n"));
 		SetInterruptFlag(INTFLAG_AUDIO);
 		TriggerInterrupt();
-		D(bug("stream: waiting for ack\n"));
-		SDL_SemWait(audio_irq_done_sem);
-		D(bug("stream: ack received\n"));
+	}
+}
 
-		// Get size of audio data
-		uint32 apple_stream_info = ReadMacInt32(audio_data + adatStreamInfo);
-		if (apple_stream_info && !main_mute && !speaker_mute) {
-			int work_size = ReadMacInt32(apple_stream_info + scd_sampleCount) * (AudioStatus.sample_size >> 3) * AudioStatus.channels;
-			D(bug("stream: work_size %d\n", work_size));
-			if (work_size > stream_len)
-				work_size = stream_len;
-			if (work_size == 0)
-				goto silence;
-
-			// Send data to audio device
-			bool dbl = AudioStatus.channels == 2 &&
-				ReadMacInt16(apple_stream_info + scd_numChannels) == 1 &&
-				ReadMacInt16(apple_stream_info + scd_sampleSize) == 8;
-			uint8 *src = Mac2HostAddr(ReadMacInt32(apple_stream_info + scd_buffer));
-			if (dbl)
-				for (int i = 0; i < work_size; i += 2)
-					audio_mix_buf[i] = audio_mix_buf[i + 1] = src[i >> 1];
-			else memcpy(audio_mix_buf, src, work_size);
-			memset((uint8 *)stream, silence_byte, stream_len);
-			SDL_MixAudio(stream, audio_mix_buf, work_size, get_audio_volume());
-
-			D(bug("stream: data written\n"));
-
-		} else
-			goto silence;
+
+/*
+ *  Streaming function
+ */
+
+static void stream_func(void *arg, uint8 *stream, int stream_len)
+{
+	uint32 work_size = 0;
+	int volume = 0;
+	if (AudioStatus.num_sources) {
+
+		// Take what is buffered, never wait for the emulation thread
+		uint32 fill = audio_ring_fill();
+		work_size = fill < (uint32)stream_len ? fill : stream_len;
+		if (work_size < (uint32)stream_len)
+			audio_underruns++;
+		D(bug("stream: work_size %d\n", work_size));
+
+		// Refill ring buffer ahead of time
+		if (fill - work_size < audio_ring_target)
+			audio_request_data();
+		if (!main_mute && !speaker_mute)
+			volume = get_audio_volume();
 
 	} else {
 
-		// Audio not active, play silence
-		silence: memset(stream, silence_byte, stream_len);
+		// Audio not active, drop buffered data
+		__atomic_store_n(&audio_ring_tail, __atomic_load_n(&audio_ring_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
 	}
-	
+
+	// CD audio to be mixed in, if any
+	const uint8 *cd = stream;
+	int cd_volume = 0;
 #if defined(BINCUE)
-	MixAudio_bincue(stream, stream_len);
+	if (stream_len <= audio_block_size && ReadAudio_bincue(audio_cd_buf, stream_len, &cd_volume))
+		cd = audio_cd_buf;
+	else
+		cd_volume = 0;
 #endif
-	
+
+	// Convert, mix and write everything in one pass, silence after the end of audio data
+	audio_ring_mix(stream, work_size, volume, cd, cd_volume);
+	mix_audio(stream + work_size, stream, 0, cd + work_size, cd_volume, stream_len - work_size);
+	D(bug("stream: data written\n"));
 }
 
 
 /*
- *  MacOS audio interrupt, read next data block
+ *  MacOS audio interrupt, read next data blocks
  */
 
 void AudioInterrupt(void)
 {
 	D(bug("AudioInterrupt\n"));
+	__atomic_store_n(&audio_irq_pending, 0, __ATOMIC_RELEASE);
+	if (audio_ring == NULL)
+		return;
 
-	// Get data from apple mixer
-	if (AudioStatus.mixer) {
+	// Get data from apple mixer until the ring buffer reaches its target fill
+	while (AudioStatus.mixer && audio_ring_fill() < audio_ring_target) {
 		M68kRegisters r;
 		r.a[0] = audio_data + adatStreamInfo;
 		r.a[1] = AudioStatus.mixer;
 		Execute68k(audio_data + adatGetSourceData, &r);
 		D(bug(" GetSourceData() returns %08lx\n", r.d[0]));
-	} else
-		WriteMacInt32(audio_data + adatStreamInfo, 0);
 
-	// Signal stream function
-	SDL_SemPost(audio_irq_done_sem);
+		// Get size of audio data
+		uint32 apple_stream_info = ReadMacInt32(audio_data + adatStreamInfo);
+		if (apple_stream_info == 0)
+			break;
+		bool dbl = AudioStatus.channels == 2 &&
+			ReadMacInt16(apple_stream_info + scd_numChannels) == 1 &&
+			ReadMacInt16(apple_stream_info + scd_sampleSize) == 8;
+		uint32 work_size = ReadMacInt32(apple_stream_info + scd_sampleCount) * (AudioStatus.sample_size >> 3) * AudioStatus.channels;
+		if (work_size > (uint32)audio_block_size)
+			work_size = audio_block_size;
+		if (work_size == 0 || work_size > audio_ring_size - audio_ring_fill())
+			break;
+
+		// Copy data to ring buffer
+		uint8 *src = Mac2HostAddr(ReadMacInt32(apple_stream_info + scd_buffer));
+		if (dbl) {
+			expand_mono_u8(audio_conv_buf, src, work_size);
+			src = audio_conv_buf;
+		}
+		audio_ring_write(src, work_size);
+	}
 	D(bug("AudioInterrupt done\n"));
 }
 
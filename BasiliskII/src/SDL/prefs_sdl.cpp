@@ -31,6 +31,8 @@
 // Platform-specific preferences items
 prefs_desc platform_prefs_items[] = {
 	{"idlewait", TYPE_BOOLEAN, false,      "sleep when idle"},
+	{"sparsebundlebands", TYPE_INT32, false, "number of band files kept open per sparse bundle disk"},
+	{"diskcache", TYPE_INT32, false,       "size of block cache per disk image in KB (0 = off)"},
 	{"sdlrender", TYPE_STRING, false,      "SDL_Renderer driver (\"auto\", \"software\" (may be faster), etc.)"},
 	{NULL, TYPE_END, false}	// End of list
 };
@@ -68,6 +68,7 @@
 #include "video.h"
 #include "video_defs.h"
 #include "video_blit.h"
+#include "video_tiles.h"
 #include "vm_alloc.h"
 #include "cdrom.h"
 
@@ -150,7 +151,11 @@ static SDL_Renderer * sdl_renderer = NULL;			// Handle to SDL2 renderer
 static SDL_threadID sdl_renderer_thread_id = 0;		// Thread ID where the SDL_renderer was created, and SDL_renderer ops should run (for compatibility w/ d3d9)
 static SDL_Texture * sdl_texture = NULL;			// Handle to a GPU texture, with which to draw guest_surface to
 static SDL_Rect sdl_update_video_rect = {0,0,0,0};  // Union of all rects to update, when updating sdl_texture
-static SDL_mutex * sdl_update_video_mutex = NULL;   // Mutex to protect sdl_update_video_rect
+static const int SDL_UPDATE_VIDEO_MAX_RECTS = 2 * VIDEO_MAX_DIRTY_RECTS;
+static SDL_Rect sdl_update_video_rects[SDL_UPDATE_VIDEO_MAX_RECTS]; // Rects to update, when updating sdl_texture
+static int sdl_update_video_nr_rects = 0;          // Number of rects to update, or -1 to update their union
+static SDL_mutex * sdl_update_video_mutex = NULL;   // Mutex to protect sdl_update_video_rect(s)
+static video_refresh_stats static_refresh_stats;   // Statistics of the static display update
 static int screen_depth;							// Depth of current screen
 #ifdef SHEEPSHAVER
 static SDL_Cursor *sdl_cursor = NULL;				// Copy of Mac cursor
@@ -838,6 +843,7 @@ static SDL_Surface *init_sdl_video(int width, int height, int depth, Uint32 flag
     sdl_update_video_rect.y = 0;
     sdl_update_video_rect.w = 0;
     sdl_update_video_rect.h = 0;
+    sdl_update_video_nr_rects = 0;
 
 	SDL_assert(guest_surface == NULL);
 	SDL_assert(host_surface == NULL);
@@ -938,38 +944,57 @@ static int present_sdl_video()
 	// modifying it!
 	LOCK_PALETTE;
 	SDL_LockMutex(sdl_update_video_mutex);
+	const uint64 start = GetTicks_usec();
+
+	// Update the dirty rects one by one, or their union if there were too many
+	const SDL_Rect *rects = sdl_update_video_rects;
+	int nr_rects = sdl_update_video_nr_rects;
+	if (nr_rects <= 0) {
+		rects = &sdl_update_video_rect;
+		nr_rects = 1;
+	}
+
     // Convert from the guest OS' pixel format, to the host OS' texture, if necessary.
     if (host_surface != guest_surface &&
 		host_surface != NULL &&
 		guest_surface != NULL)
 	{
-		SDL_Rect destRect = sdl_update_video_rect;
-		int result = SDL_BlitSurface(guest_surface, &sdl_update_video_rect, host_surface, &destRect);
-		if (result != 0) {
-			SDL_UnlockMutex(sdl_update_video_mutex);
-			UNLOCK_PALETTE;
-			return -1;
+		for (int i = 0; i < nr_rects; i++) {
+			SDL_Rect destRect = rects[i];
+			int result = SDL_BlitSurface(guest_surface, &rects[i], host_surface, &destRect);
+			if (result != 0) {
+				SDL_UnlockMutex(sdl_update_video_mutex);
+				UNLOCK_PALETTE;
+				return -1;
+			}
 		}
 	}
 	UNLOCK_PALETTE; // passed potential deadlock, can unlock palette
 	
     // Update the host OS' texture
-	uint8_t *srcPixels = (uint8_t *)host_surface->pixels +
-		sdl_update_video_rect.y * host_surface->pitch +
-		sdl_update_video_rect.x * host_surface->format->BytesPerPixel;
+	for (int i = 0; i < nr_rects; i++) {
+		const SDL_Rect &rect = rects[i];
+		if (SDL_RectEmpty(&rect))
+			continue;
 
-	uint8_t *dstPixels;
-	int dstPitch;
-	if (SDL_LockTexture(sdl_texture, &sdl_update_video_rect, (void **)&dstPixels, &dstPitch) < 0) {
-		SDL_UnlockMutex(sdl_update_video_mutex);
-		return -1;
-	}
-	for (int y = 0; y < sdl_update_video_rect.h; y++) {
-		memcpy(dstPixels, srcPixels, sdl_update_video_rect.w << 2);
-		srcPixels += host_surface->pitch;
-		dstPixels += dstPitch;
+		uint8_t *srcPixels = (uint8_t *)host_surface->pixels +
+			rect.y * host_surface->pitch +
+			rect.x * host_surface->format->BytesPerPixel;
+
+		uint8_t *dstPixels;
+		int dstPitch;
+		if (SDL_LockTexture(sdl_texture, &rect, (void **)&dstPixels, &dstPitch) < 0) {
+			SDL_UnlockMutex(sdl_update_video_mutex);
+			return -1;
+		}
+		for (int y = 0; y < rect.h; y++) {
+			memcpy(dstPixels, srcPixels, rect.w << 2);
+			srcPixels += host_surface->pitch;
+			dstPixels += dstPitch;
+		}
+		SDL_UnlockTexture(sdl_texture);
 	}
-	SDL_UnlockTexture(sdl_texture);
+	static_refresh_stats.upload_time += GetTicks_usec() - start;
 
     // We are done working with pixels in host_surface.  Reset sdl_update_video_rect, then let
     // other threads modify it, as-needed.
@@ -977,6 +1002,7 @@ static int present_sdl_video()
     sdl_update_video_rect.y = 0;
     sdl_update_video_rect.w = 0;
     sdl_update_video_rect.h = 0;
+    sdl_update_video_nr_rects = 0;
     SDL_UnlockMutex(sdl_update_video_mutex);
 
     // Copy the texture to the display
@@ -996,9 +1022,16 @@ void update_sdl_video(SDL_Surface *s, int numrects, SDL_Rect *rects)
     // TODO: make sure SDL_Renderer resources get displayed, if and when
     // MacsBug is running (and VideoInterrupt() might not get called)
     
+    // Rects are uploaded one by one, or as their union if there are too many of them
     SDL_LockMutex(sdl_update_video_mutex);
     for (int i = 0; i < numrects; ++i) {
         SDL_UnionRect(&sdl_update_video_rect, &rects[i], &sdl_update_video_rect);
+        if (sdl_update_video_nr_rects >= 0) {
+            if (sdl_update_video_nr_rects < SDL_UPDATE_VIDEO_MAX_RECTS)
+                sdl_update_video_rects[sdl_update_video_nr_rects++] = rects[i];
+            else
+                sdl_update_video_nr_rects = -1;
+        }
     }
     SDL_UnlockMutex(sdl_update_video_mutex);
 }
@@ -1141,6 +1174,7 @@ void driver_base::adapt_to_video_mode() {
 	sdl_update_video_rect.y = 0;
 	sdl_update_video_rect.w = VIDEO_MODE_X;
 	sdl_update_video_rect.h = VIDEO_MODE_Y;
+	sdl_update_video_nr_rects = -1;
 	SDL_UnlockMutex(sdl_update_video_mutex);
 	
 	// Hide cursor
@@ -1209,6 +1243,7 @@ void driver_base::update_palette(void)
 		sdl_update_video_rect.y = 0;
 		sdl_update_video_rect.w = VIDEO_MODE_X;
 		sdl_update_video_rect.h = VIDEO_MODE_Y;
+		sdl_update_video_nr_rects = -1;
 		SDL_UnlockMutex(sdl_update_video_mutex);
 	}
 }
@@ -1653,6 +1688,14 @@ void VideoExit(void)
 	// Destroy SDL video window
 	delete_sdl_video_window();
 
+#if DEBUG
+	// Report static display update times
+	const video_refresh_stats &st = static_refresh_stats;
+	if (st.frames)
+		D(bug("Static display update: %u frames, %.1f rects, scan %.1f usec, upload %.1f usec per frame\n",
+			  st.frames, double(st.rects) / st.frames, double(st.scan_time) / st.frames, double(st.upload_time) / st.frames));
+#endif
+
 	// Destroy locks
 	if (frame_buffer_lock)
 		SDL_DestroyMutex(frame_buffer_lock);
@@ -2475,222 +2518,60 @@ static void handle_events(void)
  *  Window display update
  */
 
-// Static display update (fixed frame rate, but incremental)
-static void update_display_static(driver_base *drv)
-{
-	// Incremental update code
-	int wide = 0, high = 0;
-	uint32 x1, x2, y1, y2;
-	const VIDEO_MODE &mode = drv->mode;
-	int bytes_per_row = VIDEO_MODE_ROW_BYTES;
-	uint8 *p, *p2;
-	uint32 x2_clipped, wide_clipped;
-
-	// Check for first line from top and first line from bottom that have changed
-	y1 = 0;
-	for (uint32 j = 0; j < VIDEO_MODE_Y; j++) {
-		if (memcmp(&the_buffer[j * bytes_per_row], &the_buffer_copy[j * bytes_per_row], bytes_per_row)) {
-			y1 = j;
-			break;
-		}
-	}
-	y2 = y1 - 1;
-	for (uint32 j = VIDEO_MODE_Y; j-- > y1; ) {
-		if (memcmp(&the_buffer[j * bytes_per_row], &the_buffer_copy[j * bytes_per_row], bytes_per_row)) {
-			y2 = j;
-			break;
-		}
-	}
-	high = y2 - y1 + 1;
-
-	// Check for first column from left and first column from right that have changed
-	if (high) {
-		if ((int)VIDEO_MODE_DEPTH < (int)VIDEO_DEPTH_8BIT) {
-			const int src_bytes_per_row = bytes_per_row;
-			const int dst_bytes_per_row = drv->s->pitch;
-			const int pixels_per_byte = 8/mac_depth_of_video_depth(VIDEO_MODE_DEPTH);
-
-			const uint32 line_len = TrivialBytesPerRow(VIDEO_MODE_X, VIDEO_MODE_DEPTH);
-			
-			x1 = line_len;
-			for (uint32 j = y1; j <= y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				for (uint32 i = 0; i < x1; i++) {
-					if (*p != *p2) {
-						x1 = i;
-						break;
-					}
-					p++; p2++;
-				}
-			}
-			x2 = x1;
-			for (uint32 j = y1; j <= y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				p += bytes_per_row;
-				p2 += bytes_per_row;
-				for (uint32 i = line_len; i > x2; i--) {
-					p--; p2--;
-					if (*p != *p2) {
-						x2 = i;
-						break;
-					}
-				}
-			}
-
-			x1 *= pixels_per_byte;
-			x2 *= pixels_per_byte;
-			wide = x2 - x1;
-			x2_clipped = x2 > VIDEO_MODE_X? VIDEO_MODE_X : x2;
-			wide_clipped = x2_clipped - x1;
-
-			// Update copy of the_buffer
-			if (high && wide) {
-
-				// Lock surface, if required
-				if (SDL_MUSTLOCK(drv->s))
-					SDL_LockSurface(drv->s);
-
-				// Blit to screen surface
-				int si = y1 * src_bytes_per_row + (x1 / pixels_per_byte);
-				int di = y1 * dst_bytes_per_row + x1;
-				for (uint32 j = y1; j <= y2; j++) {
-					memcpy(the_buffer_copy + si, the_buffer + si, wide / pixels_per_byte);
-					Screen_blit((uint8 *)drv->s->pixels + di, the_buffer + si, wide / pixels_per_byte);
-					si += src_bytes_per_row;
-					di += dst_bytes_per_row;
-				}
-
-				// Unlock surface, if required
-				if (SDL_MUSTLOCK(drv->s))
-					SDL_UnlockSurface(drv->s);
-
-				// Refresh display
-				update_sdl_video(drv->s, x1, y1, wide_clipped, high);
-			}
-
-		} else {
-			const int bytes_per_pixel = VIDEO_MODE_ROW_BYTES / VIDEO_MODE_X;
-			const int dst_bytes_per_row = drv->s->pitch;
-
-			x1 = VIDEO_MODE_X;
-			for (uint32 j = y1; j <= y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				for (uint32 i = 0; i < x1 * bytes_per_pixel; i++) {
-					if (*p != *p2) {
-						x1 = i / bytes_per_pixel;
-						break;
-					}
-					p++; p2++;
-				}
-			}
-			x2 = x1;
-			for (uint32 j = y1; j <= y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				p += bytes_per_row;
-				p2 += bytes_per_row;
-				for (uint32 i = VIDEO_MODE_X * bytes_per_pixel; i > x2 * bytes_per_pixel; i--) {
-					p--;
-					p2--;
-					if (*p != *p2) {
-						x2 = i / bytes_per_pixel;
-						break;
-					}
-				}
-			}
-			wide = x2 - x1;
-
-			// Update copy of the_buffer
-			if (high && wide) {
-
-				// Lock surface, if required
-				if (SDL_MUSTLOCK(drv->s))
-					SDL_LockSurface(drv->s);
-
-				// Blit to screen surface
-				for (uint32 j = y1; j <= y2; j++) {
-					uint32 i = j * bytes_per_row + x1 * bytes_per_pixel;
-					int dst_i = j * dst_bytes_per_row + x1 * bytes_per_pixel;
-					memcpy(the_buffer_copy + i, the_buffer + i, bytes_per_pixel * wide);
-					Screen_blit((uint8 *)drv->s->pixels + dst_i, the_buffer + i, bytes_per_pixel * wide);
-				}
-
-				// Unlock surface, if required
-				if (SDL_MUSTLOCK(drv->s))
-					SDL_UnlockSurface(drv->s);
-
-				// Refresh display
-				update_sdl_video(drv->s, x1, y1, wide, high);
-			}
-		}
-	}
-}
-
-// Static display update (fixed frame rate, bounding boxes based)
+// Static display update (fixed frame rate, tiles based)
 // XXX use NQD bounding boxes to help detect dirty areas?
-static void update_display_static_bbox(driver_base *drv)
+static void update_display_static(driver_base *drv)
 {
 	const VIDEO_MODE &mode = drv->mode;
-	bool blit = (int)VIDEO_MODE_DEPTH == VIDEO_DEPTH_16BIT;
+	const uint64 start = GetTicks_usec();
 
-	// Allocate bounding boxes for SDL_UpdateRects()
-	const uint32 N_PIXELS = 64;
-	const uint32 n_x_boxes = (VIDEO_MODE_X + N_PIXELS - 1) / N_PIXELS;
-	const uint32 n_y_boxes = (VIDEO_MODE_Y + N_PIXELS - 1) / N_PIXELS;
-	SDL_Rect *boxes = (SDL_Rect *)alloca(sizeof(SDL_Rect) * n_x_boxes * n_y_boxes);
-	uint32 nr_boxes = 0;
+	// Find tiles that changed since last update
+	const uint32 bytes_per_row = VIDEO_MODE_ROW_BYTES;
+	const uint32 bits_per_pixel = mac_depth_of_video_depth(VIDEO_MODE_DEPTH);
+	video_dirty_rect rects[VIDEO_MAX_DIRTY_RECTS];
+	const int nr_rects = video_find_dirty_rects(the_buffer, the_buffer_copy, VIDEO_MODE_X, VIDEO_MODE_Y,
+												bits_per_pixel, bytes_per_row, rects);
+	if (nr_rects == 0)
+		return;
 
 	// Lock surface, if required
 	if (SDL_MUSTLOCK(drv->s))
 		SDL_LockSurface(drv->s);
 
-	// Update the surface from Mac screen
-	const uint32 bytes_per_row = VIDEO_MODE_ROW_BYTES;
-	const uint32 bytes_per_pixel = bytes_per_row / VIDEO_MODE_X;
+	// Update the surface from Mac screen, it has to be converted in 16-bit
+	// mode and in modes with less than 8 bits per pixel
+	const bool blit = (int)VIDEO_MODE_DEPTH < (int)VIDEO_DEPTH_8BIT || (int)VIDEO_MODE_DEPTH == VIDEO_DEPTH_16BIT;
 	const uint32 dst_bytes_per_row = drv->s->pitch;
-	for (uint32 y = 0; y < VIDEO_MODE_Y; y += N_PIXELS) {
-		uint32 h = N_PIXELS;
-		if (h > VIDEO_MODE_Y - y)
-			h = VIDEO_MODE_Y - y;
-		for (uint32 x = 0; x < VIDEO_MODE_X; x += N_PIXELS) {
-			uint32 w = N_PIXELS;
-			if (w > VIDEO_MODE_X - x)
-				w = VIDEO_MODE_X - x;
-			const int xs = w * bytes_per_pixel;
-			const int xb = x * bytes_per_pixel;
-			bool dirty = false;
-			for (uint32 j = y; j < (y + h); j++) {
-				const uint32 yb = j * bytes_per_row;
-				const uint32 dst_yb = j * dst_bytes_per_row;
-				if (memcmp(&the_buffer[yb + xb], &the_buffer_copy[yb + xb], xs) != 0) {
-					memcpy(&the_buffer_copy[yb + xb], &the_buffer[yb + xb], xs);
-					if (blit) Screen_blit((uint8 *)drv->s->pixels + dst_yb + xb, the_buffer + yb + xb, xs);
-					dirty = true;
-				}
-			}
-			if (dirty) {
-				boxes[nr_boxes].x = x;
-				boxes[nr_boxes].y = y;
-				boxes[nr_boxes].w = w;
-				boxes[nr_boxes].h = h;
-				nr_boxes++;
-			}
+	const uint32 dst_bytes_per_pixel = drv->s->format->BytesPerPixel;
+	SDL_Rect boxes[VIDEO_MAX_DIRTY_RECTS];
+	for (int i = 0; i < nr_rects; i++) {
+		const video_dirty_rect &r = rects[i];
+		const uint32 xb = r.x * bits_per_pixel / 8;
+		const uint32 xs = ((r.x + r.w) * bits_per_pixel + 7) / 8 - xb;
+		for (uint32 j = r.y; j < r.y + r.h; j++) {
+			const uint32 yb = j * bytes_per_row;
+			memcpy(the_buffer_copy + yb + xb, the_buffer + yb + xb, xs);
+			if (blit)
+				Screen_blit((uint8 *)drv->s->pixels + j * dst_bytes_per_row + r.x * dst_bytes_per_pixel, the_buffer + yb + xb, xs);
 		}
+		boxes[i].x = r.x;
+		boxes[i].y = r.y;
+		boxes[i].w = r.w;
+		boxes[i].h = r.h;
 	}
 
 	// Unlock surface, if required
 	if (SDL_MUSTLOCK(drv->s))
 		SDL_UnlockSurface(drv->s);
 
+	static_refresh_stats.frames++;
+	static_refresh_stats.rects += nr_rects;
+	static_refresh_stats.scan_time += GetTicks_usec() - start;
+
 	// Refresh display
-	if (nr_boxes)
-		update_sdl_video(drv->s, nr_boxes, boxes);
+	update_sdl_video(drv->s, nr_rects, boxes);
 }
 
-
 // We suggest the compiler to inline the next two functions so that it
 // may specialise the code according to the current screen depth and
 // display type. A clever compiler would do that job by itself though...
@@ -2787,11 +2668,7 @@ static void video_refresh_window_static(void)
 	static uint32 tick_counter = 0;
 	if (++tick_counter >= frame_skip) {
 		tick_counter = 0;
-		const VIDEO_MODE &mode = drv->mode;
-		if ((int)VIDEO_MODE_DEPTH >= VIDEO_DEPTH_8BIT)
-			update_display_static_bbox(drv);
-		else
-			update_display_static(drv);
+		update_display_static(drv);
 	}
 }
 
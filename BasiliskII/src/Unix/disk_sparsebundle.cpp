@@ -20,26 +20,38 @@
 
 #include "disk_unix.h"
 #include "tinyxml2.h"
+#include "prefs.h"
 
 #include <errno.h>
 #include <limits.h>
 #include <algorithm>
+#include <vector>
+
+#define DEBUG 0
+#include "debug.h"
 
 #if defined __APPLE__ && defined __MACH__
 #define __MACOSX__ 1
 #endif
 
+// Default number of band files kept open per disk
+const int DEFAULT_OPEN_BANDS = 8;
+
 struct disk_sparsebundle : disk_generic {
 	disk_sparsebundle(const char *bands, int fd, bool read_only,
-		loff_t band_size, loff_t total_size)
+		loff_t band_size, loff_t total_size, int max_open)
 	: token_fd(fd), read_only(read_only), band_size(band_size),
 		total_size(total_size), band_dir(strdup(bands)),
-		band_cur(-1), band_fd(-1), band_alloc(-1) {
+		slots(std::max(max_open, 1)), use_clock(0),
+		band_opens(0), band_hits(0) {
 	}
 	
 	virtual ~disk_sparsebundle() {
-		if (band_fd != -1)
-			close(band_fd);
+		D(bug("sparsebundle %s: %lu band opens, %lu hits\n", band_dir,
+			band_opens, band_hits));
+		for (size_t i = 0; i < slots.size(); ++i)
+			if (slots[i].fd != -1)
+				close(slots[i].fd);
 		close(token_fd);
 		free(band_dir);
 	}
@@ -61,10 +73,19 @@ protected:
 	loff_t band_size, total_size;
 	char *band_dir;			// directory containing band files
 	
-	// Currently open band
-	loff_t band_cur;		// index of the band
-	int band_fd;			// -1 if not open
-	loff_t band_alloc;		// how much space is already used?
+	// Recently used bands, kept open (LRU)
+	struct band_slot {
+		band_slot() : band(-1), fd(-1), alloc(-1), last_used(0) { }
+		loff_t band;		// index of the band, -1 if slot unused
+		int fd;				// -1 if the band doesn't exist yet
+		loff_t alloc;		// how much space is already used?
+		unsigned long last_used;
+	};
+	std::vector<band_slot> slots;
+	unsigned long use_clock;
+	
+	// Statistics
+	unsigned long band_opens, band_hits;
 	
 	typedef ssize_t (disk_sparsebundle::*band_func)(char *buf, loff_t band,
 		size_t offset, size_t len);
@@ -100,9 +121,33 @@ protected:
 		OPEN_NOENT,		// Band doesn't exist yet
 		OPEN_OK,
 	};
-	open_ret open_band(loff_t band, bool create) {
-		if (band_cur == band)
-			return OPEN_OK;
+	open_ret open_band(loff_t band, bool create, band_slot *&slot) {
+		// Already open (or known not to exist)?
+		slot = NULL;
+		for (size_t i = 0; i < slots.size(); ++i) {
+			if (slots[i].band == band) {
+				slot = &slots[i];
+				break;
+			}
+		}
+		if (slot && (slot->fd != -1 || !create)) {
+			slot->last_used = ++use_clock;
+			++band_hits;
+			return slot->fd == -1 ? OPEN_NOENT : OPEN_OK;
+		}
+		
+		// Reuse least recently used slot
+		if (slot == NULL) {
+			slot = &slots[0];
+			for (size_t i = 1; i < slots.size(); ++i)
+				if (slots[i].last_used < slot->last_used)
+					slot = &slots[i];
+		}
+		if (slot->fd != -1)
+			close(slot->fd);
+		slot->band = -1;
+		slot->fd = -1;
+		slot->alloc = -1;
 		
 		char path[PATH_MAX + 1];
 		if (snprintf(path, PATH_MAX, "%s/%lx", band_dir,
@@ -110,41 +155,42 @@ protected:
 			return OPEN_FAILED;
 		}
 		
-		if (band_fd != -1)
-			close(band_fd);
-		band_alloc = -1;
-		band_cur = -1;
-		
 		int oflags = read_only ? O_RDONLY : O_RDWR;
 		if (create)
 			oflags |= O_CREAT;
-		band_fd = open(path, oflags, 0644);
-		if (band_fd == -1) {
-			return (!create && errno == ENOENT) ? OPEN_NOENT : OPEN_FAILED;
+		++band_opens;
+		int fd = open(path, oflags, 0644);
+		if (fd == -1) {
+			if (create || errno != ENOENT)
+				return OPEN_FAILED;
+			slot->band = band;
+			slot->last_used = ++use_clock;
+			return OPEN_NOENT;
 		}
 		
 		// Get the allocated size
 		if (!read_only) {
-			band_alloc = lseek(band_fd, 0, SEEK_END);
-			if (band_alloc == -1)
-				band_alloc = band_size;
+			slot->alloc = lseek(fd, 0, SEEK_END);
+			if (slot->alloc == -1)
+				slot->alloc = band_size;
 		}
-		band_cur = band;
+		slot->band = band;
+		slot->fd = fd;
+		slot->last_used = ++use_clock;
 		return OPEN_OK;
 	}
 	
 	ssize_t band_read(char *buf, loff_t band, size_t off, size_t len) {
-		open_ret st = open_band(band, false);
+		band_slot *slot;
+		open_ret st = open_band(band, false, slot);
 		if (st == OPEN_FAILED)
 			return -1;
 		
 		// Unallocated bytes 
-		size_t want = (st == OPEN_NOENT || off >= band_alloc) ? 0
-			: std::min(len, (size_t)band_alloc - off);
+		size_t want = (st == OPEN_NOENT || off >= slot->alloc) ? 0
+			: std::min(len, (size_t)slot->alloc - off);
 		if (want) {
-			if (lseek(band_fd, off, SEEK_SET) == -1)
-				return -1;
-			ssize_t err = ::read(band_fd, buf, want);
+			ssize_t err = pread(slot->fd, buf, want, off);
 			if (err < want)
 				return err;
 		}
@@ -160,18 +206,16 @@ protected:
 		for (; nz > 0 && !buf[nz-1]; --nz)
 			; // pass
 		
-		open_ret st = open_band(band, nz);
+		band_slot *slot;
+		open_ret st = open_band(band, nz, slot);
 		if (st != OPEN_OK)
 			return st == OPEN_NOENT ? len : -1;
 
-		if (lseek(band_fd, off, SEEK_SET) == -1)
-			return -1;
-		
-		size_t space = (off >= band_alloc ? 0 : band_alloc - off);
+		size_t space = (off >= slot->alloc ? 0 : slot->alloc - off);
 		size_t want = std::max(nz, std::min(space, len));
-		ssize_t err = ::write(band_fd, buf, want);
+		ssize_t err = pwrite(slot->fd, buf, want, off);
 		if (err >= 0)
-			band_alloc = std::max(band_alloc, loff_t(off + err));
+			slot->alloc = std::max(slot->alloc, loff_t(off + err));
 		if (err < want)
 			return err;
 		return len;
@@ -309,7 +353,10 @@ disk_generic::status disk_sparsebundle_factory(const char *path,
 	// We're good to go!
 	if (snprintf(buf, PATH_MAX, "%s/%s", path, "bands") >= PATH_MAX)
 		return disk_generic::DISK_INVALID;
+	int max_open = PrefsFindInt32("sparsebundlebands");
+	if (max_open <= 0)
+		max_open = DEFAULT_OPEN_BANDS;
 	*disk = new disk_sparsebundle(buf, token, read_only, band_size,
-		total_size);
+		total_size, max_open);
 	return disk_generic::DISK_VALID;
 }
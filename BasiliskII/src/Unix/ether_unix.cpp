@@ -36,16 +36,29 @@
 // Define to let the slirp library determine the right timeout for select()
 #define USE_SLIRP_TIMEOUT 1
 
+// Define to run the slirp thread on epoll() and an eventfd (Linux)
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_EVENTFD_H)
+#define USE_EPOLL 1
+#else
+#define USE_EPOLL 0
+#endif
+
 #ifdef HAVE_SYS_POLL_H
 #include <sys/poll.h>
 #endif
 
+#if USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
 #ifdef __sun__
 #define BSD_COMP 1
 #endif
 
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #ifdef ENABLE_MACOSX_ETHERHELPER
 
@@ -63,6 +76,7 @@
 
 #include <sys/wait.h>
 #include <netinet/in.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <errno.h>
@@ -150,7 +164,10 @@ static const char *net_if_script = NULL;	// Network config script
 static pthread_t slirp_thread;				// Slirp reception thread
 static bool slirp_thread_active = false;	// Flag: Slirp reception threadinstalled
 static int slirp_output_fd = -1;			// fd of slirp output pipe
-static int slirp_input_fds[2] = { -1, -1 };	// fds of slirp input pipe
+static int slirp_wakeup_fds[2] = { -1, -1 };	// fds to wake up slirp thread (eventfd or pipe)
+#if USE_EPOLL
+static int slirp_epoll_fd = -1;				// epoll instance of slirp thread
+#endif
 #ifdef HAVE_LIBVDEPLUG
 static VDECONN *vde_conn;
 #endif
@@ -166,6 +183,46 @@ const bool ether_driver_opened = true;		// Flag: is the MacOS driver opened?
 static uint8 packet_buffer[2048];
 #endif
 
+#ifdef HAVE_SLIRP
+// Packets sent to slirp, single producer (ether_do_write()) and single
+// consumer (slirp thread) ring
+const uint32 SLIRP_INPUT_RING_SIZE = 128;	// must be a power of 2
+struct slirp_input_packet {
+	int len;
+	uint8 data[1516];
+};
+static slirp_input_packet slirp_input_ring[SLIRP_INPUT_RING_SIZE];
+static uint32 slirp_input_head = 0;			// Next slot to fill
+static uint32 slirp_input_tail = 0;			// Next slot to hand over to slirp
+
+// Packets written by slirp_output() are framed with their length, the
+// reception thread reassembles them from this buffer
+static uint8 slirp_output_stream[65536];
+static uint32 slirp_output_stream_len = 0;
+#endif
+
+// Received packets, filled by the reception thread and drained by
+// ether_do_interrupt() in batches
+const uint32 ETHER_RX_RING_SIZE = 256;		// must be a power of 2
+struct ether_rx_packet {
+	int len;
+#ifndef SHEEPSHAVER
+	struct sockaddr_in from;				// Sender, for UDP tunnelling
+#endif
+	uint8 data[1516];
+};
+static ether_rx_packet ether_rx_ring[ETHER_RX_RING_SIZE];
+static uint32 ether_rx_head = 0;			// Next slot to fill
+static uint32 ether_rx_tail = 0;			// Next slot to dispatch
+static bool ether_rx_irq_pending = false;	// Flag: Ethernet interrupt triggered for queued packets
+static bool ether_rx_waiting = false;		// Flag: reception thread waits on int_ack
+static uint32 num_rx_ring_packets = 0;		// Statistics: packets passed through the ring
+static uint32 num_rx_ring_irqs = 0;			// Statistics: interrupts that found packets
+static uint32 num_rx_ring_full = 0;			// Statistics: reception thread found the ring full
+
+// Maximum number of packet fragments sent without copying
+const int ETHER_MAX_FRAGMENTS = 16;
+
 // Attached network protocols, maps protocol type to MacOS handler address
 static map<uint16, uint32> net_protocols;
 
@@ -176,8 +233,11 @@ static int16 ether_do_add_multicast(uint8 *addr);
 static int16 ether_do_del_multicast(uint8 *addr);
 static int16 ether_do_write(uint32 arg);
 static void ether_do_interrupt(void);
+static void ether_rx_ack(void);
 static void slirp_add_redirs();
 static int slirp_add_redir(const char *redir_str);
+static bool open_slirp_wakeup(void);
+static void close_slirp_wakeup(void);
 
 #ifdef ENABLE_MACOSX_ETHERHELPER
 static int get_mac_address(const char* dev, unsigned char *addr);
@@ -195,6 +255,9 @@ static bool start_thread(void)
 		printf("WARNING: Cannot init semaphore");
 		return false;
 	}
+	ether_rx_head = ether_rx_tail = 0;
+	ether_rx_irq_pending = false;
+	ether_rx_waiting = false;
 
 	Set_pthread_attr(&ether_thread_attr, 1);
 	thread_active = (pthread_create(&ether_thread, &ether_thread_attr, receive_func, NULL) == 0);
@@ -205,6 +268,17 @@ static bool start_thread(void)
 
 #ifdef HAVE_SLIRP
 	if (net_if_type == NET_IF_SLIRP) {
+#if USE_EPOLL
+		// Input queue is signalled on the eventfd, which has a NULL cookie
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.ptr = NULL;
+		slirp_epoll_fd = epoll_create(64);
+		if (slirp_epoll_fd < 0 || epoll_ctl(slirp_epoll_fd, EPOLL_CTL_ADD, slirp_wakeup_fds[0], &ev) < 0) {
+			printf("WARNING: Cannot set up slirp epoll instance\n");
+			return false;
+		}
+#endif
 		slirp_thread_active = (pthread_create(&slirp_thread, NULL, slirp_receive_func, NULL) == 0);
 		if (!slirp_thread_active) {
 			printf("WARNING: Cannot start slirp reception thread\n");
@@ -231,6 +305,12 @@ static void stop_thread(void)
 		pthread_join(slirp_thread, NULL);
 		slirp_thread_active = false;
 	}
+#if USE_EPOLL
+	if (slirp_epoll_fd >= 0) {
+		close(slirp_epoll_fd);
+		slirp_epoll_fd = -1;
+	}
+#endif
 #endif
 
 	if (thread_active) {
@@ -357,8 +437,8 @@ bool ether_init(void)
 		fd = fds[0];
 		slirp_output_fd = fds[1];
 
-		// Open slirp input pipe
-		if (pipe(slirp_input_fds) < 0)
+		// Open slirp input queue wakeup channel
+		if (!open_slirp_wakeup())
 			return false;
 
 		// Set up port redirects
@@ -540,14 +620,7 @@ open_error:
 		close(fd);
 		fd = -1;
 	}
-	if (slirp_input_fds[0] >= 0) {
-		close(slirp_input_fds[0]);
-		slirp_input_fds[0] = -1;
-	}
-	if (slirp_input_fds[1] >= 0) {
-		close(slirp_input_fds[1]);
-		slirp_input_fds[1] = -1;
-	}
+	close_slirp_wakeup();
 	if (slirp_output_fd >= 0) {
 		close(slirp_output_fd);
 		slirp_output_fd = -1;
@@ -577,11 +650,8 @@ void ether_exit(void)
 	if (fd > 0)
 		close(fd);
 
-	// Close slirp input buffer
-	if (slirp_input_fds[0] >= 0)
-		close(slirp_input_fds[0]);
-	if (slirp_input_fds[1] >= 0)
-		close(slirp_input_fds[1]);
+	// Close slirp input queue wakeup channel
+	close_slirp_wakeup();
 
 	// Close slirp output buffer
 	if (slirp_output_fd > 0)
@@ -592,6 +662,7 @@ void ether_exit(void)
 	if (net_if_type == NET_IF_VDE)
 		vde_close(vde_conn);
 #endif
+	D(bug("%u packets received in %u interrupts, receive ring full %u times\n", num_rx_ring_packets, num_rx_ring_irqs, num_rx_ring_full));
 #if STATISTICS
 	// Show statistics
 	printf("%ld messages put on write queue\n", num_wput);
@@ -693,6 +764,30 @@ static inline int ether_arg_to_buffer(uint32 mp, uint8 *p)
 	return ether_msgb_to_buffer(mp, p);
 }
 
+// Point I/O vector at packet data in message block, returns number of
+// entries or -1 if there are more than max_iov fragments
+static int ether_arg_to_iovec(uint32 mp, struct iovec *iov, int max_iov, int &len)
+{
+	int n = 0;
+	len = 0;
+	while (mp && len < 1514) {
+		uint32 data = ReadMacInt32(mp + 12);
+		int size = ReadMacInt32(mp + 16) - data;
+		if (size > 0) {
+			if (n == max_iov)
+				return -1;
+			if (size > 1514 - len)
+				size = 1514 - len;
+			iov[n].iov_base = Mac2HostAddr(data);
+			iov[n].iov_len = size;
+			n++;
+			len += size;
+		}
+		mp = ReadMacInt32(mp + 8);
+	}
+	return n;
+}
+
 // Ethernet interrupt
 void EtherIRQ(void)
 {
@@ -705,7 +800,7 @@ void EtherIRQ(void)
 
 	// Acknowledge interrupt to reception thread
 	D(bug(" EtherIRQ done\n"));
-	sem_post(&int_ack);
+	ether_rx_ack();
 }
 #else
 // Add multicast address
@@ -732,6 +827,29 @@ static inline int ether_arg_to_buffer(uint32 wds, uint8 *p)
 	return ether_wds_to_buffer(wds, p);
 }
 
+// Point I/O vector at packet data in WDS, returns number of entries or -1
+// if there are more than max_iov fragments
+static int ether_arg_to_iovec(uint32 wds, struct iovec *iov, int max_iov, int &len)
+{
+	int n = 0;
+	len = 0;
+	while (len < 1514) {
+		int w = ReadMacInt16(wds);
+		if (w == 0)
+			break;
+		if (n == max_iov)
+			return -1;
+		if (w > 1514 - len)
+			w = 1514 - len;
+		iov[n].iov_base = Mac2HostAddr(ReadMacInt32(wds + 2));
+		iov[n].iov_len = w;
+		n++;
+		len += w;
+		wds += 6;
+	}
+	return n;
+}
+
 // Dispatch packet to protocol handler
 static void ether_dispatch_packet(uint32 p, uint32 length)
 {
@@ -771,7 +889,7 @@ void EtherInterrupt(void)
 
 	// Acknowledge interrupt to reception thread
 	D(bug(" EtherIRQ done\n"));
-	sem_post(&int_ack);
+	ether_rx_ack();
 }
 #endif
 
@@ -861,22 +979,40 @@ int16 ether_detach_ph(uint16 type)
 
 static int16 ether_do_write(uint32 arg)
 {
-	// Copy packet to buffer
-	uint8 packet[1516], *p = packet;
+	// Point I/O vector at the packet fragments in MacOS memory, the first
+	// entry is reserved for the Linux ethertap header. sheep_net and VDE
+	// want the packet in a linear buffer (sheep_net only implements
+	// write(), so writev() would turn every fragment into a packet).
+	struct iovec iov[1 + ETHER_MAX_FRAGMENTS];
+	uint8 packet[1516];
 	int len = 0;
+	int n = -1;
+	if (net_if_type != NET_IF_SHEEPNET && net_if_type != NET_IF_VDE)
+		n = ether_arg_to_iovec(arg, iov + 1, ETHER_MAX_FRAGMENTS, len);
+	if (n < 0) {
+		len = ether_arg_to_buffer(arg, packet);
+		iov[1].iov_base = packet;
+		iov[1].iov_len = len;
+		n = 1;
+	}
+	struct iovec *vec = iov + 1;
 #if defined(__linux__)
 	if (net_if_type == NET_IF_ETHERTAP) {
-		*p++ = 0;	// Linux ethertap discards the first 2 bytes
-		*p++ = 0;
+		static uint8 ethertap_header[2] = {0, 0};	// Linux ethertap discards the first 2 bytes
+		vec = iov;
+		vec[0].iov_base = ethertap_header;
+		vec[0].iov_len = 2;
+		n++;
 		len += 2;
 	}
 #endif
-	len += ether_arg_to_buffer(arg, p);
 
 #if MONITOR
 	bug("Sending Ethernet packet:\n");
-	for (int i=0; i<len; i++) {
-		bug("%02x ", packet[i]);
+	for (int i=0; i<n; i++) {
+		for (size_t j=0; j<vec[i].iov_len; j++) {
+			bug("%02x ", ((uint8 *)vec[i].iov_base)[j]);
+		}
 	}
 	bug("\n");
 #endif
@@ -884,9 +1020,29 @@ static int16 ether_do_write(uint32 arg)
 	// Transmit packet
 #ifdef HAVE_SLIRP
 	if (net_if_type == NET_IF_SLIRP) {
-		const int slirp_input_fd = slirp_input_fds[1];
-		write(slirp_input_fd, &len, sizeof(len));
-		write(slirp_input_fd, packet, len);
+		// Queue packet for the slirp thread, drop it if the ring is full
+		const uint32 head = slirp_input_head;
+		if (head - __atomic_load_n(&slirp_input_tail, __ATOMIC_ACQUIRE) >= SLIRP_INPUT_RING_SIZE) {
+			D(bug("WARNING: slirp input queue full, packet dropped\n"));
+			return excessCollsns;
+		}
+		slirp_input_packet *p = &slirp_input_ring[head & (SLIRP_INPUT_RING_SIZE - 1)];
+		uint8 *q = p->data;
+		for (int i=0; i<n; i++) {
+			memcpy(q, vec[i].iov_base, vec[i].iov_len);
+			q += vec[i].iov_len;
+		}
+		p->len = len;
+		__atomic_store_n(&slirp_input_head, head + 1, __ATOMIC_RELEASE);
+
+		// Wake up the slirp thread
+#if USE_EPOLL
+		uint64_t one = 1;
+		write(slirp_wakeup_fds[1], &one, sizeof(one));
+#else
+		char c = 0;
+		write(slirp_wakeup_fds[1], &c, 1);
+#endif
 		return noErr;
 	} else
 #endif
@@ -918,13 +1074,13 @@ static int16 ether_do_write(uint32 arg)
 			return excessCollsns;
 		}
 
-		if (write(fd, packet, len) < len) {
+		if (writev(fd, vec, n) < len) {
 			return excessCollsns;
 		}
 		return noErr;
 	} else
 #endif
-	if (write(fd, packet, len) < 0) {
+	if (writev(fd, vec, n) < 0) {
 		D(bug("WARNING: Couldn't transmit packet\n"));
 		return excessCollsns;
 	} else
@@ -955,6 +1111,43 @@ void ether_stop_udp_thread(void)
 }
 
 
+/*
+ *  SLIRP input queue
+ */
+
+static bool open_slirp_wakeup(void)
+{
+#if USE_EPOLL
+	int efd = eventfd(0, EFD_NONBLOCK);
+	if (efd < 0)
+		return false;
+	slirp_wakeup_fds[0] = slirp_wakeup_fds[1] = efd;
+#else
+	if (pipe(slirp_wakeup_fds) < 0)
+		return false;
+	// A full pipe already holds a pending wakeup, so writes may fail
+	// instead of blocking ether_do_write()
+	for (int i = 0; i < 2; i++) {
+		int val = fcntl(slirp_wakeup_fds[i], F_GETFL, 0);
+		if (val < 0 || fcntl(slirp_wakeup_fds[i], F_SETFL, val | O_NONBLOCK) < 0) {
+			close_slirp_wakeup();
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+static void close_slirp_wakeup(void)
+{
+	if (slirp_wakeup_fds[1] >= 0 && slirp_wakeup_fds[1] != slirp_wakeup_fds[0])
+		close(slirp_wakeup_fds[1]);
+	if (slirp_wakeup_fds[0] >= 0)
+		close(slirp_wakeup_fds[0]);
+	slirp_wakeup_fds[0] = slirp_wakeup_fds[1] = -1;
+}
+
+
 /*
  *  SLIRP output buffer glue
  */
@@ -967,38 +1160,113 @@ int slirp_can_output(void)
 
 void slirp_output(const uint8 *packet, int len)
 {
-	write(slirp_output_fd, packet, len);
+	// Prefix packet with its length, a pipe doesn't keep message boundaries
+	uint16 pkt_len = len;
+	struct iovec iov[2];
+	iov[0].iov_base = &pkt_len;
+	iov[0].iov_len = sizeof(pkt_len);
+	iov[1].iov_base = (void *)packet;
+	iov[1].iov_len = len;
+	writev(slirp_output_fd, iov, 2);
+}
+
+// Hand packets queued by ether_do_write() over to slirp
+static void slirp_drain_input(void)
+{
+	// Acknowledge wakeups first, so that none is lost for later packets
+#if USE_EPOLL
+	uint64_t count;
+	read(slirp_wakeup_fds[0], &count, sizeof(count));
+#else
+	char buf[64];
+	while (read(slirp_wakeup_fds[0], buf, sizeof(buf)) > 0)
+		;
+#endif
+
+	uint32 tail = slirp_input_tail;
+	while (tail != __atomic_load_n(&slirp_input_head, __ATOMIC_ACQUIRE)) {
+		const slirp_input_packet *p = &slirp_input_ring[tail & (SLIRP_INPUT_RING_SIZE - 1)];
+		slirp_input(p->data, p->len);
+		__atomic_store_n(&slirp_input_tail, ++tail, __ATOMIC_RELEASE);
+	}
+}
+
+#if USE_EPOLL
+// Update epoll interest list for one slirp socket
+static void slirp_epoll_update(int sfd, int old_events, int new_events, void *opaque)
+{
+	struct epoll_event ev;
+	ev.events = 0;
+	if (new_events & SLIRP_POLL_IN)
+		ev.events |= EPOLLIN;
+	if (new_events & SLIRP_POLL_OUT)
+		ev.events |= EPOLLOUT;
+	if (new_events & SLIRP_POLL_PRI)
+		ev.events |= EPOLLPRI;
+	ev.data.ptr = opaque;
+
+	if (new_events == 0)
+		epoll_ctl(slirp_epoll_fd, EPOLL_CTL_DEL, sfd, &ev);
+	else if (old_events == 0) {
+		if (epoll_ctl(slirp_epoll_fd, EPOLL_CTL_ADD, sfd, &ev) < 0 && errno == EEXIST)
+			epoll_ctl(slirp_epoll_fd, EPOLL_CTL_MOD, sfd, &ev);
+	}
+	else {
+		if (epoll_ctl(slirp_epoll_fd, EPOLL_CTL_MOD, sfd, &ev) < 0 && errno == ENOENT)
+			epoll_ctl(slirp_epoll_fd, EPOLL_CTL_ADD, sfd, &ev);
+	}
 }
 
 void *slirp_receive_func(void *arg)
 {
-	const int slirp_input_fd = slirp_input_fds[0];
+	for (;;) {
+		// Process packets from the input queue
+		slirp_drain_input();
+
+		// Wait for packets to arrive in the input queue or on slirp sockets
+		const int MAX_EVENTS = 64;
+		struct epoll_event events[MAX_EVENTS];
+		int timeout = slirp_pollfds_fill(slirp_epoll_update);
+#if ! USE_SLIRP_TIMEOUT
+		timeout = 10000;
+#endif
+		int n = epoll_wait(slirp_epoll_fd, events, MAX_EVENTS, (timeout + 999) / 1000);
+		for (int i = 0; i < n; i++) {
+			if (events[i].data.ptr == NULL)
+				continue;
+			const uint32 e = events[i].events;
+			int revents = 0;
+			if (e & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				revents |= SLIRP_POLL_IN;
+			if (e & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+				revents |= SLIRP_POLL_OUT;
+			if (e & EPOLLPRI)
+				revents |= SLIRP_POLL_PRI;
+			slirp_pollfds_set_revents(events[i].data.ptr, revents);
+		}
+		slirp_pollfds_poll();
+	}
+	return NULL;
+}
+#else
+void *slirp_receive_func(void *arg)
+{
+	const int slirp_wakeup_fd = slirp_wakeup_fds[0];
 
 	for (;;) {
-		// Wait for packets to arrive
+		// Process packets from the input queue
+		slirp_drain_input();
+
+		// Wait for packets to arrive in the input queue or on slirp sockets
 		fd_set rfds, wfds, xfds;
 		int nfds;
 		struct timeval tv;
 
-		// ... in the input queue
-		FD_ZERO(&rfds);
-		FD_SET(slirp_input_fd, &rfds);
-		tv.tv_sec = 0;
-		tv.tv_usec = 0;
-		if (select(slirp_input_fd + 1, &rfds, NULL, NULL, &tv) > 0) {
-			int len;
-			read(slirp_input_fd, &len, sizeof(len));
-			uint8 packet[1516];
-			assert(len <= sizeof(packet));
-			read(slirp_input_fd, packet, len);
-			slirp_input(packet, len);
-		}
-
-		// ... in the output queue
-		nfds = -1;
+		nfds = slirp_wakeup_fd;
 		FD_ZERO(&rfds);
 		FD_ZERO(&wfds);
 		FD_ZERO(&xfds);
+		FD_SET(slirp_wakeup_fd, &rfds);
 		int timeout = slirp_select_fill(&nfds, &rfds, &wfds, &xfds);
 #if ! USE_SLIRP_TIMEOUT
 		timeout = 10000;
@@ -1016,6 +1284,7 @@ void *slirp_receive_func(void *arg)
 	}
 	return NULL;
 }
+#endif
 #else
 int slirp_can_output(void)
 {
@@ -1028,6 +1297,144 @@ void slirp_output(const uint8 *packet, int len)
 #endif
 
 
+/*
+ *  Receive ring
+ */
+
+// Trigger Ethernet interrupt for queued packets, unless one is already pending
+static void ether_rx_kick(void)
+{
+	if (__atomic_load_n(&ether_rx_tail, __ATOMIC_ACQUIRE) == ether_rx_head)
+		return;
+	if (!__atomic_exchange_n(&ether_rx_irq_pending, true, __ATOMIC_SEQ_CST)) {
+		D(bug(" packets received, triggering Ethernet interrupt\n"));
+		SetInterruptFlag(INTFLAG_ETHER);
+		TriggerInterrupt();
+	}
+}
+
+// Get next free slot of receive ring, waits for the MacOS to make room if the ring is full
+static ether_rx_packet *ether_rx_get_slot(void)
+{
+	uint32 head = ether_rx_head;
+	if (head - __atomic_load_n(&ether_rx_tail, __ATOMIC_ACQUIRE) == ETHER_RX_RING_SIZE) {
+		num_rx_ring_full++;
+		ether_rx_kick();
+
+		// Every interrupt acknowledge may have made room. int_ack is only
+		// posted while ether_rx_waiting is set, so it can't pile up
+		// while the ring has room and turn this into a busy loop
+		for (;;) {
+			__atomic_store_n(&ether_rx_waiting, true, __ATOMIC_SEQ_CST);
+			if (head - __atomic_load_n(&ether_rx_tail, __ATOMIC_SEQ_CST) != ETHER_RX_RING_SIZE)
+				break;
+			sem_wait(&int_ack);
+		}
+		__atomic_store_n(&ether_rx_waiting, false, __ATOMIC_SEQ_CST);
+	}
+	return &ether_rx_ring[head & (ETHER_RX_RING_SIZE - 1)];
+}
+
+// Wake up reception thread if it waits for an interrupt acknowledge
+static void ether_rx_ack(void)
+{
+	// Order the ether_rx_tail update of ether_do_interrupt() before the
+	// check, ether_rx_get_slot() does the opposite
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_exchange_n(&ether_rx_waiting, false, __ATOMIC_SEQ_CST))
+		sem_post(&int_ack);
+}
+
+// Hand slot returned by ether_rx_get_slot() over to ether_do_interrupt()
+static inline void ether_rx_put_slot(void)
+{
+	__atomic_store_n(&ether_rx_head, ether_rx_head + 1, __ATOMIC_SEQ_CST);
+}
+
+#ifdef HAVE_SLIRP
+// Split data written by slirp_output() into packets
+static void slirp_receive_packets(void)
+{
+	ssize_t res = read(fd, slirp_output_stream + slirp_output_stream_len, sizeof(slirp_output_stream) - slirp_output_stream_len);
+	if (res <= 0)
+		return;
+
+	uint32 len = slirp_output_stream_len + res;
+	uint32 pos = 0;
+	for (;;) {
+		uint16 pkt_len;
+		if (len - pos < sizeof(pkt_len))
+			break;
+		memcpy(&pkt_len, slirp_output_stream + pos, sizeof(pkt_len));
+		if (len - pos < sizeof(pkt_len) + pkt_len)
+			break;
+		pos += sizeof(pkt_len);
+
+		if (pkt_len <= sizeof(ether_rx_ring[0].data)) {
+			ether_rx_packet *slot = ether_rx_get_slot();
+			memcpy(slot->data, slirp_output_stream + pos, pkt_len);
+			slot->len = pkt_len;
+			ether_rx_put_slot();
+		}
+		pos += pkt_len;
+	}
+
+	// Keep incomplete packet for next time
+	slirp_output_stream_len = len - pos;
+	memmove(slirp_output_stream, slirp_output_stream + pos, slirp_output_stream_len);
+}
+#endif
+
+// Move all packets waiting on the network device to the receive ring
+static void ether_receive_packets(void)
+{
+#ifdef HAVE_SLIRP
+	if (net_if_type == NET_IF_SLIRP) {
+		slirp_receive_packets();
+		ether_rx_kick();
+		return;
+	}
+#endif
+
+	for (;;) {
+		ether_rx_packet *slot = ether_rx_get_slot();
+		ssize_t length;
+
+#ifndef SHEEPSHAVER
+		if (udp_tunnel) {
+
+			// Read packet from socket
+			socklen_t from_len = sizeof(slot->from);
+			length = recvfrom(fd, slot->data, 1514, 0, (struct sockaddr *)&slot->from, &from_len);
+
+		} else
+#endif
+		{
+#ifdef HAVE_LIBVDEPLUG
+			if (net_if_type == NET_IF_VDE) {
+				length = vde_recv(vde_conn, slot->data, 1514, 0);
+			} else
+#endif
+			{
+				// Read packet from sheep_net device
+#if defined(__linux__)
+				length = read(fd, slot->data, net_if_type == NET_IF_ETHERTAP ? 1516 : 1514);
+#else
+				length = read(fd, slot->data, 1514);
+#endif
+			}
+		}
+
+		if (length < 14)
+			break;
+		slot->len = length;
+		ether_rx_put_slot();
+	}
+
+	ether_rx_kick();
+}
+
+
 /*
  *  Packet reception thread
  */
@@ -1062,16 +1469,23 @@ static void *receive_func(void *arg)
 			if (read_packet() < 1) {
 				break;
 			}
+
+			if (ether_driver_opened) {
+				// Trigger Ethernet interrupt
+				D(bug(" packet received, triggering Ethernet interrupt\n"));
+				__atomic_store_n(&ether_rx_waiting, true, __ATOMIC_SEQ_CST);
+				SetInterruptFlag(INTFLAG_ETHER);
+				TriggerInterrupt();
+
+				// Wait for interrupt acknowledge by EtherInterrupt()
+				sem_wait(&int_ack);
+			}
+			continue;
 		}
 #endif
 		if (ether_driver_opened) {
-			// Trigger Ethernet interrupt
-			D(bug(" packet received, triggering Ethernet interrupt\n"));
-			SetInterruptFlag(INTFLAG_ETHER);
-			TriggerInterrupt();
-
-			// Wait for interrupt acknowledge by EtherInterrupt()
-			sem_wait(&int_ack);
+			// Queue packets and go on reading while the MacOS handles them
+			ether_receive_packets();
 		} else
 			Delay_usec(20000);
 	}
@@ -1088,51 +1502,41 @@ void ether_do_interrupt(void)
 	// Call protocol handler for received packets
 	EthernetPacket ether_packet;
 	uint32 packet = ether_packet.addr();
-	ssize_t length;
-	for (;;) {
 
-#ifndef SHEEPSHAVER
-		if (udp_tunnel) {
-
-			// Read packet from socket
-			struct sockaddr_in from;
-			socklen_t from_len = sizeof(from);
-			length = recvfrom(fd, Mac2HostAddr(packet), 1514, 0, (struct sockaddr *)&from, &from_len);
-			if (length < 14)
-				break;
-			ether_udp_read(packet, length, &from);
-
-		} else
-#endif
 #ifdef ENABLE_MACOSX_ETHERHELPER
-		if (net_if_type == NET_IF_ETHERHELPER) {
-			unsigned short *pkt_len;
-			uint32 p = packet;
+	if (net_if_type == NET_IF_ETHERHELPER) {
+		unsigned short *pkt_len;
+		uint32 p = packet;
 
-			pkt_len = (unsigned short *)packet_buffer;
-			length = *pkt_len;
-			memcpy(Mac2HostAddr(packet), pkt_len + 1, length);
-			ether_dispatch_packet(p, length);
-			break;
-		} else
-#endif
-		{
-#ifdef HAVE_LIBVDEPLUG
-			if (net_if_type == NET_IF_VDE) {
-				length = vde_recv(vde_conn, Mac2HostAddr(packet), 1514, 0);
-			} else
+		pkt_len = (unsigned short *)packet_buffer;
+		ssize_t length = *pkt_len;
+		memcpy(Mac2HostAddr(packet), pkt_len + 1, length);
+		ether_dispatch_packet(p, length);
+		return;
+	}
 #endif
-			{
-				// Read packet from sheep_net device
-#if defined(__linux__)
-				length = read(fd, Mac2HostAddr(packet), net_if_type == NET_IF_ETHERTAP ? 1516 : 1514);
-#else
-				length = read(fd, Mac2HostAddr(packet), 1514);
+
+	uint32 num_packets = 0;
+	uint32 tail = ether_rx_tail;
+	for (;;) {
+		while (tail != __atomic_load_n(&ether_rx_head, __ATOMIC_ACQUIRE)) {
+
+			// Copy packet to MacOS memory, which frees the slot
+			ether_rx_packet *slot = &ether_rx_ring[tail & (ETHER_RX_RING_SIZE - 1)];
+			ssize_t length = slot->len;
+			Host2Mac_memcpy(packet, slot->data, length);
+#ifndef SHEEPSHAVER
+			struct sockaddr_in from = slot->from;
 #endif
-			}
+			__atomic_store_n(&ether_rx_tail, ++tail, __ATOMIC_RELEASE);
+			num_packets++;
 
-			if (length < 14)
-				break;
+#ifndef SHEEPSHAVER
+			if (udp_tunnel) {
+				ether_udp_read(packet, length, &from);
+				continue;
+			}
+#endif
 
 #if MONITOR
 			bug("Receiving Ethernet packet:\n");
@@ -1154,6 +1558,17 @@ void ether_do_interrupt(void)
 			// Dispatch packet
 			ether_dispatch_packet(p, length);
 		}
+
+		// Packets queued after this point trigger a new interrupt, make
+		// sure that none slipped in before
+		__atomic_store_n(&ether_rx_irq_pending, false, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&ether_rx_head, __ATOMIC_SEQ_CST) == tail)
+			break;
+	}
+
+	if (num_packets) {
+		num_rx_ring_irqs++;
+		num_rx_ring_packets += num_packets;
 	}
 }
 
@@ -102,11 +102,9 @@ using std::string;
 
 #if USE_JIT
 #ifdef UPDATE_UAE
-extern void (*flush_icache)(void); // from compemu_support.cpp
 extern bool UseJIT;
-#else
-extern void flush_icache_range(uint8 *start, uint32 size); // from compemu_support.cpp
 #endif
+extern void flush_icache_range(uint8 *start, uint32 size); // from compemu_support.cpp
 #endif
 
 #ifdef ENABLE_MON
@@ -169,6 +167,9 @@ static bool tick_thread_active = false;				// Flag: 60Hz thread installed
 static volatile bool tick_thread_cancel = false;	// Flag: Cancel 60Hz thread
 static pthread_t tick_thread;						// 60Hz thread
 static pthread_attr_t tick_thread_attr;				// 60Hz thread attributes
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_active = false;				// Flag: 60Hz tick run by timer thread
+#endif
 
 static pthread_mutex_t intflag_lock = PTHREAD_MUTEX_INITIALIZER;	// Mutex to protect InterruptFlags
 #define LOCK_INTFLAGS pthread_mutex_lock(&intflag_lock)
@@ -219,6 +220,9 @@ static const char *gui_connection_path = NULL;	// GUI connection identifier
 static void *xpram_func(void *arg);
 static void *tick_func(void *arg);
 static void one_tick(...);
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_func(void);
+#endif
 #if !EMULATED_68K
 static void sigirq_handler(int sig, int code, struct sigcontext *scp);
 static void sigill_handler(int sig, int code, struct sigcontext *scp);
@@ -886,15 +890,22 @@ int main(int argc, char **argv)
 #ifndef USE_CPU_EMUL_SERVICES
 #if defined(HAVE_PTHREADS)
 
-	// POSIX threads available, start 60Hz thread
-	Set_pthread_attr(&tick_thread_attr, 0);
-	tick_thread_active = (pthread_create(&tick_thread, &tick_thread_attr, tick_func, NULL) == 0);
-	if (!tick_thread_active) {
-		sprintf(str, GetString(STR_TICK_THREAD_ERR), strerror(errno));
-		ErrorAlert(str);
-		QuitEmulator();
+#ifdef PRECISE_TIMING_TIMERFD
+	// Let the timer thread drive the 60Hz tick if possible
+	tick_timer_active = TimerStartTick(tick_timer_func, 16625);
+	if (!tick_timer_active)
+#endif
+	{
+		// POSIX threads available, start 60Hz thread
+		Set_pthread_attr(&tick_thread_attr, 0);
+		tick_thread_active = (pthread_create(&tick_thread, &tick_thread_attr, tick_func, NULL) == 0);
+		if (!tick_thread_active) {
+			sprintf(str, GetString(STR_TICK_THREAD_ERR), strerror(errno));
+			ErrorAlert(str);
+			QuitEmulator();
+		}
+		D(bug("60Hz thread started\n"));
 	}
-	D(bug("60Hz thread started\n"));
 
 #elif defined(HAVE_TIMER_CREATE) && defined(_POSIX_REALTIME_SIGNALS)
 
@@ -985,6 +996,12 @@ void QuitEmulator(void)
 		  (long)emulated_ticks_count, (long)(emulated_ticks_end - emulated_ticks_start),
 		  emulated_ticks_count * 1000000.0 / (emulated_ticks_end - emulated_ticks_start), (long)n_check_ticks));
 #elif defined(USE_PTHREADS_SERVICES)
+#ifdef PRECISE_TIMING_TIMERFD
+	// Stop 60Hz tick
+	if (tick_timer_active)
+		TimerStopTick();
+#endif
+
 	// Stop 60Hz thread
 	if (tick_thread_active) {
 		tick_thread_cancel = true;
@@ -1072,12 +1089,8 @@ void FlushCodeCache(void *start, uint32 size)
 {
 #if USE_JIT
     if (UseJIT)
-#ifdef UPDATE_UAE
-		flush_icache();
-#else
 		flush_icache_range((uint8 *)start, size);
 #endif
-#endif
 #if !EMULATED_68K && defined(__NetBSD__)
 	m68k_sync_icache(start, size);
 #endif
@@ -1355,6 +1368,15 @@ static void *tick_func(void *arg)
 #endif
 	return NULL;
 }
+
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_func(void)
+{
+	if (!tick_inhibit)
+		one_tick();
+	return true;
+}
+#endif
 #endif
 
 
@@ -41,6 +41,8 @@ prefs_desc platform_prefs_items[] = {
 	{"dsp", TYPE_STRING, false,            "audio output (dsp) device name"},
 	{"mixer", TYPE_STRING, false,          "audio mixer device name"},
 	{"idlewait", TYPE_BOOLEAN, false,      "sleep when idle"},
+	{"sparsebundlebands", TYPE_INT32, false, "number of band files kept open per sparse bundle disk"},
+	{"diskcache", TYPE_INT32, false,       "size of block cache per disk image in KB (0 = off)"},
 #ifdef USE_SDL_VIDEO
 	{"sdlrender", TYPE_STRING, false,      "SDL_Renderer driver (\"auto\", \"software\" (may be faster), etc.)"},
 #endif
@@ -24,6 +24,10 @@
 #include <sys/stat.h>
 #include <errno.h>
 
+#include <map>
+#include <vector>
+#include <algorithm>
+
 #ifdef HAVE_AVAILABILITYMACROS_H
 #include <AvailabilityMacros.h>
 #endif
@@ -77,6 +81,9 @@ static disk_factory *disk_factories[] = {
 	NULL
 };
 
+// Block cache of a file handle
+struct disk_cache;
+
 // File handles are pointers to these structures
 struct mac_file_handle {
 	char *name;	        // Copy of device/file name
@@ -92,6 +99,7 @@ struct mac_file_handle {
 
 	bool is_media_present;		// Flag: media is inserted and available
 	disk_generic *generic_disk;
+	disk_cache *cache;			// Block cache (NULL = uncached)
 
 #if defined(__linux__)
 	int cdrom_cap;		// CD-ROM capability flags (only valid if is_cdrom is true)
@@ -121,6 +129,40 @@ static mac_file_handle *first_floppy = NULL;
 // Prototypes
 static void cdrom_close(mac_file_handle *fh);
 static bool cdrom_open(mac_file_handle *fh, const char *path = NULL);
+static size_t raw_read(mac_file_handle *fh, void *buffer, loff_t offset, size_t length);
+static size_t raw_write(mac_file_handle *fh, void *buffer, loff_t offset, size_t length);
+
+// Block cache parameters
+const size_t CACHE_BLOCK_SIZE = 4096;	// Size of one cache block
+const int CACHE_MAX_READ_AHEAD = 16;	// Maximum number of blocks to read ahead
+
+// One cached block of a file handle
+struct cache_block {
+	loff_t offset;		// Offset of block in file (multiple of CACHE_BLOCK_SIZE)
+	size_t valid;		// Number of valid bytes (less than CACHE_BLOCK_SIZE at end of file)
+	bool dirty;			// Flag: block was modified and must be written back
+	int prev, next;		// LRU list links (-1 = none)
+	uint8 *data;		// Block data
+};
+
+// Block cache (write-back, LRU replacement), shared by the emulator thread
+// and the I/O threads of the disk drivers, all accesses hold the lock
+struct disk_cache {
+	B2_mutex *lock;
+	std::vector<cache_block> blocks;
+	std::map<loff_t, int> index;	// Offset -> block number
+	uint8 *data;		// Data of all blocks
+	uint8 *buffer;		// Buffer for read-ahead and write-back runs
+	int num_used;		// Number of blocks in use
+	int lru_head;		// Most recently used block
+	int lru_tail;		// Least recently used block
+	loff_t next_read;	// End of last read (for detecting sequential access)
+	int read_ahead;		// Current read-ahead in blocks
+
+	// Statistics
+	uint32 hits, misses;
+	uint32 read_ahead_blocks, write_back_blocks;
+};
 
 
 /*
@@ -522,6 +564,309 @@ static bool is_drive_mounted(const char *dev_name, char *mount_name)
 }
 
 
+/*
+ *  Block cache
+ */
+
+// Unlink block from LRU list
+static void cache_lru_remove(disk_cache *c, int i)
+{
+	cache_block &b = c->blocks[i];
+	if (b.prev >= 0)
+		c->blocks[b.prev].next = b.next;
+	else
+		c->lru_head = b.next;
+	if (b.next >= 0)
+		c->blocks[b.next].prev = b.prev;
+	else
+		c->lru_tail = b.prev;
+	b.prev = b.next = -1;
+}
+
+// Insert block at head of LRU list
+static void cache_lru_insert(disk_cache *c, int i)
+{
+	cache_block &b = c->blocks[i];
+	b.prev = -1;
+	b.next = c->lru_head;
+	if (c->lru_head >= 0)
+		c->blocks[c->lru_head].prev = i;
+	else
+		c->lru_tail = i;
+	c->lru_head = i;
+}
+
+// Find cached block, returns block number or -1
+static int cache_find(disk_cache *c, loff_t offset)
+{
+	std::map<loff_t, int>::const_iterator it = c->index.find(offset);
+	if (it == c->index.end())
+		return -1;
+	cache_lru_remove(c, it->second);
+	cache_lru_insert(c, it->second);
+	return it->second;
+}
+
+// Report failed write-back of dirty blocks
+static void cache_write_error(mac_file_handle *fh, loff_t offset, size_t length)
+{
+	printf("WARNING: Cannot write back %lu cached bytes at offset %lld to %s\n", (unsigned long)length, (long long)offset, fh->name);
+}
+
+// Get free block for given offset, evicting the least recently used block if necessary,
+// returns block number or -1 if the evicted block could not be written back
+static int cache_alloc(mac_file_handle *fh, loff_t offset)
+{
+	disk_cache *c = fh->cache;
+	int i;
+	if (c->num_used < int(c->blocks.size()))
+		i = c->num_used++;
+	else {
+		i = c->lru_tail;
+		cache_block &b = c->blocks[i];
+		if (b.dirty) {
+			if (raw_write(fh, b.data, b.offset, b.valid) != b.valid) {
+				cache_write_error(fh, b.offset, b.valid);
+				return -1;	// Keep dirty block, the request fails
+			}
+			c->write_back_blocks++;
+		}
+		c->index.erase(b.offset);
+		cache_lru_remove(c, i);
+	}
+	cache_block &b = c->blocks[i];
+	b.offset = offset;
+	b.valid = 0;
+	b.dirty = false;
+	c->index[offset] = i;
+	cache_lru_insert(c, i);
+	return i;
+}
+
+// Read block and up to "count - 1" following uncached blocks, returns block number or -1
+// (past end of file or write-back error)
+static int cache_fill(mac_file_handle *fh, loff_t offset, int count)
+{
+	disk_cache *c = fh->cache;
+	int n = 1;
+	while (n < count && c->index.find(offset + n * CACHE_BLOCK_SIZE) == c->index.end())
+		n++;
+
+	size_t actual = raw_read(fh, c->buffer, offset, n * CACHE_BLOCK_SIZE);
+	if (actual == 0)
+		return -1;
+
+	int first = -1;
+	for (int j = 0; j < n && actual > j * CACHE_BLOCK_SIZE; j++) {
+		int i = cache_alloc(fh, offset + j * CACHE_BLOCK_SIZE);
+		if (i < 0)
+			break;
+		cache_block &b = c->blocks[i];
+		b.valid = std::min(actual - j * CACHE_BLOCK_SIZE, CACHE_BLOCK_SIZE);
+		memcpy(b.data, c->buffer + j * CACHE_BLOCK_SIZE, b.valid);
+		if (j == 0)
+			first = i;
+		else
+			c->read_ahead_blocks++;
+	}
+
+	// The requested block must stay the most recently used one
+	if (first < 0)
+		return -1;
+	cache_lru_remove(c, first);
+	cache_lru_insert(c, first);
+	return first;
+}
+
+// Write run of dirty blocks collected in the cache buffer, the blocks stay dirty on error
+static bool cache_write_run(mac_file_handle *fh, loff_t offset, size_t length, const int *run, int count)
+{
+	disk_cache *c = fh->cache;
+	if (raw_write(fh, c->buffer, offset, length) != length) {
+		cache_write_error(fh, offset, length);
+		return false;
+	}
+	for (int j = 0; j < count; j++)
+		c->blocks[run[j]].dirty = false;
+	c->write_back_blocks += count;
+	return true;
+}
+
+// Write back all dirty blocks, combining adjacent blocks, returns false on error
+static bool cache_flush(mac_file_handle *fh)
+{
+	disk_cache *c = fh->cache;
+	bool ok = true;
+	loff_t run_start = 0;
+	size_t run_length = 0;
+	int run[CACHE_MAX_READ_AHEAD];
+	int run_count = 0;
+	std::map<loff_t, int>::const_iterator it, end = c->index.end();
+	for (it = c->index.begin(); it != end; ++it) {
+		cache_block &b = c->blocks[it->second];
+		if (!b.dirty)
+			continue;
+		if (run_length && (b.offset != run_start + loff_t(run_length) || run_length % CACHE_BLOCK_SIZE || run_count == CACHE_MAX_READ_AHEAD)) {
+			ok &= cache_write_run(fh, run_start, run_length, run, run_count);
+			run_length = 0;
+			run_count = 0;
+		}
+		if (run_length == 0)
+			run_start = b.offset;
+		memcpy(c->buffer + run_length, b.data, b.valid);
+		run_length += b.valid;
+		run[run_count++] = it->second;
+	}
+	if (run_length)
+		ok &= cache_write_run(fh, run_start, run_length, run, run_count);
+	return ok;
+}
+
+// Write back and drop all blocks, returns false if dirty blocks could not be
+// written back (the cache is kept then, so no data is lost)
+static bool cache_invalidate(mac_file_handle *fh)
+{
+	disk_cache *c = fh->cache;
+	if (c == NULL)
+		return true;
+
+	B2_lock_mutex(c->lock);
+	bool ok = cache_flush(fh);
+	if (ok) {
+		c->index.clear();
+		c->num_used = 0;
+		c->lru_head = c->lru_tail = -1;
+		c->next_read = -1;
+		c->read_ahead = 0;
+	}
+	B2_unlock_mutex(c->lock);
+	return ok;
+}
+
+// Set up block cache for file handle if enabled in prefs
+static void cache_open(mac_file_handle *fh)
+{
+	int32 size = PrefsFindInt32("diskcache");
+	if (size <= 0)
+		return;
+
+	int num_blocks = std::max(int((size_t)size * 1024 / CACHE_BLOCK_SIZE), 4 * CACHE_MAX_READ_AHEAD);
+	disk_cache *c = new disk_cache;
+	c->lock = B2_create_mutex();
+	c->blocks.resize(num_blocks);
+	c->data = new uint8[num_blocks * CACHE_BLOCK_SIZE];
+	c->buffer = new uint8[CACHE_MAX_READ_AHEAD * CACHE_BLOCK_SIZE];
+	for (int i = 0; i < num_blocks; i++)
+		c->blocks[i].data = c->data + i * CACHE_BLOCK_SIZE;
+	c->hits = c->misses = 0;
+	c->read_ahead_blocks = c->write_back_blocks = 0;
+	fh->cache = c;
+	cache_invalidate(fh);
+	D(bug(" %d cache blocks for %s\n", num_blocks, fh->name));
+}
+
+// Write back and delete block cache of file handle
+static void cache_close(mac_file_handle *fh)
+{
+	disk_cache *c = fh->cache;
+	if (c == NULL)
+		return;
+
+	B2_lock_mutex(c->lock);
+	if (!cache_flush(fh))
+		printf("WARNING: Modified data of %s lost\n", fh->name);
+	B2_unlock_mutex(c->lock);
+	D(bug("Disk cache for %s: %u hits, %u misses, %u blocks read ahead, %u blocks written\n",
+		fh->name, c->hits, c->misses, c->read_ahead_blocks, c->write_back_blocks));
+	B2_delete_mutex(c->lock);
+	delete[] c->data;
+	delete[] c->buffer;
+	delete c;
+	fh->cache = NULL;
+}
+
+// Read through block cache
+static size_t cache_read(mac_file_handle *fh, void *buffer, loff_t offset, size_t length)
+{
+	disk_cache *c = fh->cache;
+	B2_lock_mutex(c->lock);
+
+	// Sequential access? Then double read-ahead, otherwise switch it off
+	if (offset == c->next_read)
+		c->read_ahead = std::min(std::max(c->read_ahead * 2, 1), CACHE_MAX_READ_AHEAD - 1);
+	else
+		c->read_ahead = 0;
+
+	size_t done = 0;
+	while (done < length) {
+		loff_t pos = offset + done;
+		loff_t block_offset = pos - pos % CACHE_BLOCK_SIZE;
+		size_t skip = pos - block_offset;
+
+		int i = cache_find(c, block_offset);
+		if (i >= 0)
+			c->hits++;
+		else {
+			c->misses++;
+			int count = int((skip + length - done + CACHE_BLOCK_SIZE - 1) / CACHE_BLOCK_SIZE);
+			i = cache_fill(fh, block_offset, std::min(count + c->read_ahead, CACHE_MAX_READ_AHEAD));
+			if (i < 0)
+				break;
+		}
+
+		cache_block &b = c->blocks[i];
+		if (skip >= b.valid)
+			break;
+		size_t n = std::min(length - done, b.valid - skip);
+		memcpy((uint8 *)buffer + done, b.data + skip, n);
+		done += n;
+		if (b.valid < CACHE_BLOCK_SIZE)
+			break;	// End of file
+	}
+	c->next_read = offset + done;
+	B2_unlock_mutex(c->lock);
+	return done;
+}
+
+// Write into block cache, returns less than "length" if dirty blocks could not be written back
+static size_t cache_write(mac_file_handle *fh, void *buffer, loff_t offset, size_t length)
+{
+	disk_cache *c = fh->cache;
+	B2_lock_mutex(c->lock);
+
+	size_t done = 0;
+	while (done < length) {
+		loff_t pos = offset + done;
+		loff_t block_offset = pos - pos % CACHE_BLOCK_SIZE;
+		size_t skip = pos - block_offset;
+		size_t n = std::min(length - done, CACHE_BLOCK_SIZE - skip);
+
+		int i = cache_find(c, block_offset);
+		if (i >= 0)
+			c->hits++;
+		else {
+			c->misses++;
+			if (n < CACHE_BLOCK_SIZE)
+				i = cache_fill(fh, block_offset, 1);	// Partial write, read rest of block first
+			if (i < 0)
+				i = cache_alloc(fh, block_offset);
+			if (i < 0)
+				break;
+		}
+
+		cache_block &b = c->blocks[i];
+		if (skip > b.valid)
+			memset(b.data + b.valid, 0, skip - b.valid);
+		memcpy(b.data + skip, (uint8 *)buffer + done, n);
+		b.valid = std::max(b.valid, skip + n);
+		b.dirty = true;
+		done += n;
+	}
+	B2_unlock_mutex(c->lock);
+	return done;
+}
+
+
 /*
  *  Open file/device, create new file handle (returns NULL on error)
  */
@@ -533,6 +878,7 @@ static mac_file_handle *open_filehandle(const char *name)
 		fh->name = strdup(name);
 		fh->fd = -1;
 		fh->generic_disk = NULL;
+		fh->cache = NULL;
 #if defined __MACOSX__
 		fh->ioctl_fd = -1;
 		fh->ioctl_name = NULL;
@@ -620,6 +966,8 @@ void *Sys_open(const char *name, bool read_only, bool is_cdrom)
 			fh->file_size = generic->size();
 			fh->read_only = generic->is_read_only();
 			fh->is_media_present = true;
+			if (!is_cdrom)
+				cache_open(fh);
 			sys_add_mac_file_handle(fh);
 			return fh;
 		}
@@ -667,6 +1015,8 @@ void *Sys_open(const char *name, bool read_only, bool is_cdrom)
 			lseek(fd, 0, SEEK_SET);
 			read(fd, data, 256);
 			FileDiskLayout(size, data, fh->start_byte, fh->file_size);
+			if (!is_cdrom)
+				cache_open(fh);	// CD-ROM images are read-only, the host caches them well enough
 		} else {
 			struct stat st;
 			if (fstat(fd, &st) == 0) {
@@ -726,6 +1076,7 @@ void Sys_close(void *arg)
 		return;
 
 	sys_remove_mac_file_handle(fh);
+	cache_close(fh);
 
 #if defined(BINCUE)
 	if (fh->is_bincue)
@@ -760,15 +1111,28 @@ size_t Sys_read(void *arg, void *buffer, loff_t offset, size_t length)
 		return read_bincue(fh->bincue_fd, buffer, offset, length);
 #endif
 
+	if (fh->cache)
+		return cache_read(fh, buffer, offset, length);
+	return raw_read(fh, buffer, offset, length);
+}
+
+static size_t raw_read(mac_file_handle *fh, void *buffer, loff_t offset, size_t length)
+{
 	if (fh->generic_disk)
 		return fh->generic_disk->read(buffer, offset, length);
-	
-	// Seek to position
-	if (lseek(fh->fd, offset + fh->start_byte, SEEK_SET) < 0)
-		return 0;
 
-	// Read data
-	return read(fh->fd, buffer, length);
+	// Read data, retrying short reads
+	loff_t pos = offset + fh->start_byte;
+	size_t done = 0;
+	while (done < length) {
+		ssize_t actual = pread(fh->fd, (uint8 *)buffer + done, length - done, pos + done);
+		if (actual < 0 && errno == EINTR)
+			continue;
+		if (actual <= 0)
+			break;
+		done += actual;
+	}
+	return done;
 }
 
 
@@ -783,15 +1147,28 @@ size_t Sys_write(void *arg, void *buffer, loff_t offset, size_t length)
 	if (!fh)
 		return 0;
 
+	if (fh->cache && !fh->read_only)
+		return cache_write(fh, buffer, offset, length);
+	return raw_write(fh, buffer, offset, length);
+}
+
+static size_t raw_write(mac_file_handle *fh, void *buffer, loff_t offset, size_t length)
+{
 	if (fh->generic_disk)
 		return fh->generic_disk->write(buffer, offset, length);
 
-	// Seek to position
-	if (lseek(fh->fd, offset + fh->start_byte, SEEK_SET) < 0)
-		return 0;
-
-	// Write data
-	return write(fh->fd, buffer, length);
+	// Write data, retrying short writes
+	loff_t pos = offset + fh->start_byte;
+	size_t done = 0;
+	while (done < length) {
+		ssize_t actual = pwrite(fh->fd, (uint8 *)buffer + done, length - done, pos + done);
+		if (actual < 0 && errno == EINTR)
+			continue;
+		if (actual <= 0)
+			break;
+		done += actual;
+	}
+	return done;
 }
 
 
@@ -849,6 +1226,8 @@ void SysEject(void *arg)
 	if (!fh)
 		return;
 
+	cache_invalidate(fh);
+
 #if defined(__linux__)
 	if (fh->is_floppy) {
 		if (fh->fd >= 0) {
@@ -499,7 +499,10 @@ static inline uae_u32 do_byteswap_16(uae_u32 v)
 #define memptr uint32
 
 // High-precision timing
-#if defined(HAVE_PTHREADS) && defined(HAVE_CLOCK_NANOSLEEP)
+#if defined(HAVE_PTHREADS) && defined(HAVE_SYS_TIMERFD_H) && defined(HAVE_SYS_EPOLL_H)
+#define PRECISE_TIMING 1
+#define PRECISE_TIMING_TIMERFD 1
+#elif defined(HAVE_PTHREADS) && defined(HAVE_CLOCK_NANOSLEEP)
 #define PRECISE_TIMING 1
 #define PRECISE_TIMING_POSIX 1
 #elif defined(HAVE_PTHREADS) && defined(__MACH__)
@@ -106,6 +106,8 @@ void timer_current_time(tm_time_t &t)
 {
 #if defined(__MACH__)
 	mach_current_time(t);
+#elif defined(PRECISE_TIMING_TIMERFD)
+	clock_gettime(CLOCK_MONOTONIC, &t);	// Same clock as timer thread
 #elif defined(HAVE_CLOCK_GETTIME)
 	clock_gettime(CLOCK_REALTIME, &t);
 #else
@@ -65,6 +65,7 @@
 #include "user_strings.h"
 #include "video.h"
 #include "video_blit.h"
+#include "video_tiles.h"
 
 #define DEBUG 0
 #include "debug.h"
@@ -96,6 +97,7 @@ static bool local_X11;								// Flag: X server running on local machine?
 static uint8 *the_buffer = NULL;					// Mac frame buffer (where MacOS draws into)
 static uint8 *the_buffer_copy = NULL;				// Copy of Mac frame buffer (for refreshed modes)
 static uint32 the_buffer_size;						// Size of allocated the_buffer
+static video_refresh_stats static_refresh_stats;	// Statistics of the static display update
 
 static bool redraw_thread_active = false;			// Flag: Redraw thread installed
 #ifdef HAVE_PTHREADS
@@ -1889,6 +1891,14 @@ void VideoExit(void)
 	for (i = VideoMonitors.begin(); i != end; ++i)
 		dynamic_cast<X11_monitor_desc *>(*i)->video_close();
 
+#if DEBUG
+	// Report static display update times
+	const video_refresh_stats &st = static_refresh_stats;
+	if (st.frames)
+		D(bug("Static display update: %u frames, %.1f rects, scan %.1f usec, upload %.1f usec per frame\n",
+			  st.frames, double(st.rects) / st.frames, double(st.scan_time) / st.frames, double(st.upload_time) / st.frames));
+#endif
+
 #ifdef ENABLE_XF86_VIDMODE
 	// Free video mode list
 	if (x_video_modes) {
@@ -2434,123 +2444,49 @@ static void update_display_dynamic(int ticker, driver_window *drv)
 	XDisplayUnlock();
 }
 
-// Static display update (fixed frame rate, but incremental)
+// Static display update (fixed frame rate, tiles based)
 static void update_display_static(driver_window *drv)
 {
-	// Incremental update code
-	unsigned wide = 0, high = 0, x1, x2, y1, y2, i, j;
 	const video_mode &mode = drv->monitor.get_current_mode();
-	int bytes_per_row = mode.bytes_per_row;
-	int bytes_per_pixel = mode.bytes_per_row / mode.x;
-	uint8 *p, *p2;
-
-	// Check for first line from top and first line from bottom that have changed
-	y1 = 0;
-	for (j=0; j<mode.y; j++) {
-		if (memcmp(&the_buffer[j * bytes_per_row], &the_buffer_copy[j * bytes_per_row], bytes_per_row)) {
-			y1 = j;
-			break;
-		}
-	}
-	y2 = y1 - 1;
-	for (j=mode.y-1; j>=y1; j--) {
-		if (memcmp(&the_buffer[j * bytes_per_row], &the_buffer_copy[j * bytes_per_row], bytes_per_row)) {
-			y2 = j;
-			break;
-		}
-	}
-	high = y2 - y1 + 1;
-
-	// Check for first column from left and first column from right that have changed
-	if (high) {
-		if (mode.depth == VDEPTH_1BIT) {
-			x1 = mode.x - 1;
-			for (j=y1; j<=y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				for (i=0; i<(x1>>3); i++) {
-					if (*p != *p2) {
-						x1 = i << 3;
-						break;
-					}
-					p++; p2++;
-				}
-			}
-			x2 = x1;
-			for (j=y1; j<=y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				p += bytes_per_row;
-				p2 += bytes_per_row;
-				for (i=(mode.x>>3); i>(x2>>3); i--) {
-					p--; p2--;
-					if (*p != *p2) {
-						x2 = (i << 3) + 7;
-						break;
-					}
-				}
-			}
-			wide = x2 - x1 + 1;
-
-			// Update copy of the_buffer
-			if (high && wide) {
-				for (j=y1; j<=y2; j++) {
-					i = j * bytes_per_row + (x1 >> 3);
-					memcpy(the_buffer_copy + i, the_buffer + i, wide >> 3);
-				}
-			}
-
-		} else {
-			x1 = mode.x;
-			for (j=y1; j<=y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				for (i=0; i<x1*bytes_per_pixel; i++) {
-					if (*p != *p2) {
-						x1 = i / bytes_per_pixel;
-						break;
-					}
-					p++; p2++;
-				}
-			}
-			x2 = x1;
-			for (j=y1; j<=y2; j++) {
-				p = &the_buffer[j * bytes_per_row];
-				p2 = &the_buffer_copy[j * bytes_per_row];
-				p += bytes_per_row;
-				p2 += bytes_per_row;
-				for (i=mode.x*bytes_per_pixel; i>x2*bytes_per_pixel; i--) {
-					p--;
-					p2--;
-					if (*p != *p2) {
-						x2 = i / bytes_per_pixel;
-						break;
-					}
-				}
-			}
-			wide = x2 - x1;
+	const uint64 start = GetTicks_usec();
+
+	// Find tiles that changed since last update
+	const uint32 bytes_per_row = mode.bytes_per_row;
+	const uint32 bits_per_pixel = 1 << mode.depth;
+	video_dirty_rect rects[VIDEO_MAX_DIRTY_RECTS];
+	const int nr_rects = video_find_dirty_rects(the_buffer, the_buffer_copy, mode.x, mode.y,
+												bits_per_pixel, bytes_per_row, rects);
+	if (nr_rects == 0)
+		return;
 
-			// Update copy of the_buffer
-			if (high && wide) {
-				for (j=y1; j<=y2; j++) {
-					i = j * bytes_per_row + x1 * bytes_per_pixel;
-					memcpy(the_buffer_copy + i, the_buffer + i, bytes_per_pixel * wide);
-				}
-			}
+	// Update copy of the_buffer
+	for (int i = 0; i < nr_rects; i++) {
+		const video_dirty_rect &r = rects[i];
+		const uint32 xb = r.x * bits_per_pixel / 8;
+		const uint32 xs = ((r.x + r.w) * bits_per_pixel + 7) / 8 - xb;
+		for (uint32 j = r.y; j < r.y + r.h; j++) {
+			const uint32 yb = j * bytes_per_row;
+			memcpy(the_buffer_copy + yb + xb, the_buffer + yb + xb, xs);
 		}
 	}
+	const uint64 upload_start = GetTicks_usec();
 
 	// Refresh display
 	XDisplayLock();
-	if (high && wide) {
+	for (int i = 0; i < nr_rects; i++) {
+		const video_dirty_rect &r = rects[i];
 		if (drv->have_shm)
-			XShmPutImage(x_display, drv->w, drv->gc, drv->img, x1, y1, x1, y1, wide, high, 0);
+			XShmPutImage(x_display, drv->w, drv->gc, drv->img, r.x, r.y, r.x, r.y, r.w, r.h, 0);
 		else
-			XPutImage(x_display, drv->w, drv->gc, drv->img, x1, y1, x1, y1, wide, high);
+			XPutImage(x_display, drv->w, drv->gc, drv->img, r.x, r.y, r.x, r.y, r.w, r.h);
 	}
 	XDisplayUnlock();
-}
 
+	static_refresh_stats.frames++;
+	static_refresh_stats.rects += nr_rects;
+	static_refresh_stats.scan_time += upload_start - start;
+	static_refresh_stats.upload_time += GetTicks_usec() - upload_start;
+}
 
 /*
  *	Screen refresh functions
@@ -1098,31 +1098,70 @@ bool HaveAudioToMix_bincue() {
 	return currently_playing != NULL;
 }
 
-void MixAudio_bincue(uint8 *stream, int dest_stream_len)
+// How many bytes of source data (CD audio) make up dest_stream_len bytes of output?
+static int source_stream_len(int dest_stream_len)
 {
-	if (!dest_stream_len) return;
+	OutputSettings & o = current_output_settings;
+	int source_channels_sample = 44100 * 2 * 2;
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+	int dest_format_bytes = SDL_AUDIO_BYTESIZE((SDL_AudioFormat) o.format);
+#else
+	int dest_format_bytes = o.format == AUDIO_U8 ? 1 : 2;
+#endif
+	int dest_channels_sample = o.freq * o.channels * dest_format_bytes;
+	return (int)((uint64) dest_stream_len * source_channels_sample / dest_channels_sample);
+}
+
+#if !SDL_VERSION_ATLEAST(3, 0, 0)
+/*
+ *  Get CD audio converted to the output format, for the caller to mix;
+ *  returns number of bytes stored in buf (0 or dest_stream_len)
+ */
 
+int ReadAudio_bincue(uint8 *buf, int dest_stream_len, int *volume)
+{
+	if (!dest_stream_len) return 0;
+
+	int len = 0;
 	if (currently_playing) {
 		LOCK_PLAYER;
 
 		CDPlayer *player = currently_playing;
+		int src_stream_len = source_stream_len(dest_stream_len);
 
-		OutputSettings & o = current_output_settings;
+		if (player->audiostatus == CDROM_AUDIO_PLAY) {
+			uint8 *src = fill_buffer(src_stream_len, player);
+			if (src)
+				SDL_AudioStreamPut(player->stream, src, src_stream_len);
+			int avail = SDL_AudioStreamAvailable(player->stream);
+			if (avail >= dest_stream_len) {
+				SDL_AudioStreamGet(player->stream, buf, dest_stream_len);
+				len = dest_stream_len;
+				*volume = player->volume_mono;
+				// Apply 60% volume while scanning (ff/reverse)
+				if (player->scanning) *volume = *volume * 3 / 5;
+			}
+		}
+		UNLOCK_PLAYER;
+	}
+	return len;
+}
+#endif
+
+void MixAudio_bincue(uint8 *stream, int dest_stream_len)
+{
+	if (!dest_stream_len) return;
 
-		/** How many bytes do we need in terms of source data (CD audio)? */
-		int source_channels_sample = 44100 * 2 * 2;
 #if SDL_VERSION_ATLEAST(3, 0, 0)
-		int dest_format_bytes = SDL_AUDIO_BYTESIZE((SDL_AudioFormat) o.format);
-#else
-		int dest_format_bytes = o.format == AUDIO_U8 ? 1 : 2;
-#endif
-		int dest_channels_sample = o.freq * o.channels * dest_format_bytes;
-		int src_stream_len = (int)((uint64) dest_stream_len * source_channels_sample / dest_channels_sample);
+	if (currently_playing) {
+		LOCK_PLAYER;
+
+		CDPlayer *player = currently_playing;
+		int src_stream_len = source_stream_len(dest_stream_len);
 
 		if (player->audiostatus == CDROM_AUDIO_PLAY) {
 			//D(bug("MixAudio cd playing, player=0x%p\n", player));
 			uint8 *buf = fill_buffer(src_stream_len, player);
-#if SDL_VERSION_ATLEAST(3, 0, 0)
 			if (buf)
 				SDL_PutAudioStreamData(player->stream, buf, src_stream_len);
 			int avail = SDL_GetAudioStreamAvailable(player->stream);
@@ -1133,25 +1172,17 @@ void MixAudio_bincue(uint8 *stream, int dest_stream_len)
 				float volume = (float)player->volume_mono/128;
 				// Apply 60% volume while scanning (ff/reverse)
 				if (player->scanning) volume *= 0.6;
-				SDL_MixAudio(stream, converted, (SDL_AudioFormat) o.format, dest_stream_len, volume);
+				SDL_MixAudio(stream, converted, (SDL_AudioFormat) current_output_settings.format, dest_stream_len, volume);
 			}
-#else
-			if (buf)
-				SDL_AudioStreamPut(player->stream, buf, src_stream_len);
-			int avail = SDL_AudioStreamAvailable(player->stream);
-			if (avail >= dest_stream_len) {
-				//D(bug("have bytes avail %d stream len %d\n", avail, dest_stream_len));
-				uint8 converted[dest_stream_len];
-				SDL_AudioStreamGet(player->stream, converted, dest_stream_len);
-				int volume = player->volume_mono;
-				// Apply 60% volume while scanning (ff/reverse)
-				if (player->scanning) volume = volume * 3 / 5;
-				SDL_MixAudio(stream, converted, dest_stream_len, volume);
-			}
-#endif
 		}
 		UNLOCK_PLAYER;
 	}
+#else
+	uint8 converted[dest_stream_len];
+	int volume;
+	if (ReadAudio_bincue(converted, dest_stream_len, &volume))
+		SDL_MixAudio(stream, converted, dest_stream_len, volume);
+#endif
 }
 
 static void OpenPlayerStream(CDPlayer * player) {
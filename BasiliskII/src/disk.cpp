@@ -45,6 +45,8 @@ using std::vector;
 #define DEBUG 0
 #include "debug.h"
 
+#include "disk_async.h"
+
 
 // .Disk Disk/drive icon
 const uint8 DiskIcon[258] = {
@@ -96,6 +98,9 @@ uint32 DiskIconAddr;
 // Flag: Control(accRun) has been called, interrupt routine is now active
 static bool acc_run_called = false;
 
+// Asynchronous Prime() requests
+static disk_async_io async_io;
+
 
 /*
  *  Get pointer to drive info or drives.end() if not found
@@ -168,6 +173,10 @@ void DiskInit(void)
 		if (fh)
 			drives.push_back(disk_drive_info(fh, SysIsReadOnly(fh)));
 	}
+
+	// Start I/O thread for asynchronous requests
+	if (!drives.empty())
+		async_io.start();
 }
 
 
@@ -177,6 +186,9 @@ void DiskInit(void)
 
 void DiskExit(void)
 {
+	// Stop I/O thread
+	async_io.stop();
+
 	drive_vec::iterator info, end = drives.end();
 	for (info = drives.begin(); info != end; ++info)
 		info->close_fh();
@@ -194,6 +206,7 @@ bool DiskMountVolume(void *fh)
 	while (info != end && info->fh != fh)
 		++info;
 	if (info != end) {
+		async_io.wait_idle();
 		if (SysIsDiskInserted(info->fh)) {
 			info->read_only = SysIsReadOnly(info->fh);
 			WriteMacInt8(info->status + dsDiskInPlace, 1);	// Inserted removable disk
@@ -254,6 +267,9 @@ int16 DiskOpen(uint32 pb, uint32 dce)
 	WriteMacInt32(dce + dCtlPosition, 0);
 	acc_run_called = false;
 
+	// Allocate Deferred Task structure for asynchronous requests
+	async_io.open();
+
 	// Install drives
 	drive_vec::iterator info, end = drives.end();
 	for (info = drives.begin(); info != end; ++info) {
@@ -330,8 +346,17 @@ int16 DiskPrime(uint32 pb, uint32 dce)
 	if ((length & 0x1ff) || (position & 0x1ff))
 		return paramErr;
 
+	bool write = (ReadMacInt16(pb + ioTrap) & 0xff) != aRdCmd;
+	if (write && info->read_only)
+		return wPrErr;
+
+	// Asynchronous queued request? Then pass it to the I/O thread and return "pending"
+	if (acc_run_called && async_io.queue(pb, dce, info->fh, buffer, position + info->start_byte, length, write))
+		return 1;
+	async_io.wait_idle();
+
 	size_t actual = 0;
-	if ((ReadMacInt16(pb + ioTrap) & 0xff) == aRdCmd) {
+	if (!write) {
 
 		// Read
 		actual = Sys_read(info->fh, buffer, position + info->start_byte, length);
@@ -341,8 +366,6 @@ int16 DiskPrime(uint32 pb, uint32 dce)
 	} else {
 
 		// Write
-		if (info->read_only)
-			return wPrErr;
 		actual = Sys_write(info->fh, buffer, position + info->start_byte, length);
 		if (actual != length)
 			return writErr;
@@ -399,6 +422,7 @@ int16 DiskControl(uint32 pb, uint32 dce)
 				return offLinErr;
 
 		case 7:		// Eject disk
+			async_io.wait_idle();
 			if (ReadMacInt8(info->status + dsDiskInPlace) == 8) {
 				// Fixed disk, re-insert
 				M68kRegisters r;
@@ -469,7 +493,7 @@ int16 DiskStatus(uint32 pb, uint32 dce)
 					WriteMacInt32(pb + csParam + 4, EMULATOR_ID_4);
 					break;
 				case FOURCC('s','y','n','c'):	// Only synchronous operation?
-					WriteMacInt32(pb + csParam + 4, 0x01000000);
+					WriteMacInt32(pb + csParam + 4, async_io.enabled() ? 0 : 0x01000000);
 					break;
 				case FOURCC('b','o','o','t'):	// Boot ID
 					if (info != drives.end())
@@ -544,3 +568,14 @@ void DiskInterrupt(void)
 
 	mount_mountable_volumes();
 }
+
+
+/*
+ *  Disk I/O interrupt - asynchronous Prime() completed, activate Deferred Task to call IODone
+ */
+
+void DiskIOInterrupt(void)
+{
+	if (async_io.complete())
+		D(bug("DiskIOInterrupt\n"));
+}
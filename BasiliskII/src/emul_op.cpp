@@ -491,6 +491,12 @@ void EmulOp(uint16 opcode, M68kRegisters *r)
 				SerialInterrupt();
 			}
 
+			if (InterruptFlags & INTFLAG_DISK) {
+				ClearInterruptFlag(INTFLAG_DISK);
+				SonyIOInterrupt();
+				DiskIOInterrupt();
+			}
+
 			if (InterruptFlags & INTFLAG_ETHER) {
 				ClearInterruptFlag(INTFLAG_ETHER);
 				EtherInterrupt();
@@ -43,6 +43,10 @@
 #include <fcntl.h>
 #include <errno.h>
 
+#include <vector>
+#include <string>
+#include <algorithm>
+
 #ifndef WIN32
 #include <unistd.h>
 #include <dirent.h>
@@ -52,6 +56,12 @@
 #include <sys/attr.h>
 #endif
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <list>
+#include <map>
+#endif
+
 #include "cpu_emulation.h"
 #include "emul_op.h"
 #include "main.h"
@@ -152,22 +162,51 @@ const uint8 ExtFSIcon[256] = {
 };
 
 
+// Cached host attributes of a file/dir (see get_item_attrs())
+struct FSItemAttrs {
+	bool valid;				// Attributes are valid
+	time_t time;			// Time attributes were read
+	uint32 dir_gen;			// Change generation of parent directory when attributes were read
+	uint32 global_gen;		// Global change generation when attributes were read
+	bool is_dir;			// Item is a directory
+	bool locked;			// Item is not writable
+	off_t size;				// Data fork size
+	time_t mtime;			// Modification time
+	uint32 crtime;			// Creation time (MacOS format)
+	uint32 rf_size;			// Resource fork size
+	uint8 finfo[SIZEOF_FInfo];		// Finder info
+	uint8 fxinfo[SIZEOF_FXInfo];	// Extended Finder info
+};
+
 // These objects are used to map CNIDs to path names
 struct FSItem {
 	FSItem *next;			// Pointer to next FSItem in list
+	FSItem *next_id;		// Pointer to next FSItem in CNID hash chain
+	FSItem *next_name;		// Pointer to next FSItem in (parent, host name) hash chain
+	FSItem *next_guest;		// Pointer to next FSItem in (parent, guest name) hash chain
 	uint32 id;				// CNID of this file/dir
 	uint32 parent_id;		// CNID of parent file/dir
 	FSItem *parent;			// Pointer to parent
 	char *name;				// Object name (C string) - Host OS
+	char *path;				// Full path (C string) - Host OS, built on demand (NULL = not built yet)
 	char guest_name[32];	// Object name (C string) - Guest OS
 	time_t mtime;			// Modification time for get_cat_info caching
 	int cache_dircount;		// Cached number of files in directory
+	FSItemAttrs *attrs;		// Cached host attributes (NULL = none)
+	uint32 dir_gen;			// Change generation of directory contents
+	int watch;				// inotify watch descriptor of directory (0 = not watched, -1 = watching failed)
 };
 
 static FSItem *first_fs_item, *last_fs_item;
 
 static uint32 next_cnid = fsUsrCNID;	// Next available CNID
 
+// Hash tables for looking up FSItems by CNID and by (parent, host/guest name)
+const uint32 FSITEM_HASH_MIN_SIZE = 1024;	// Initial number of buckets (power of 2)
+static FSItem **id_hash, **name_hash, **guest_hash;
+static uint32 fsitem_hash_size;		// Number of buckets in each table
+static uint32 num_fs_items;			// Number of FSItems in the tables
+
 
 /*
  *  Get object creation time
@@ -207,17 +246,111 @@ static uint32 get_creation_time(const char *path)
 #endif
 
 
+/*
+ *  FSItem hash tables
+ */
+
+static inline uint32 hash_id(uint32 cnid)
+{
+	return (cnid * 2654435761U) >> 8;
+}
+
+static uint32 hash_name(const FSItem *parent, const char *name)
+{
+	// FNV-1a over the parent pointer and the name
+	uint32 h = 2166136261U ^ uint32(uintptr(parent) >> 4);
+	h *= 16777619U;
+	uint8 c;
+	while ((c = *name++) != 0) {
+		h ^= c;
+		h *= 16777619U;
+	}
+	return h;
+}
+
+// Append item to the end of a hash chain (so lookups find the oldest matching item first, like a list walk)
+static void link_hash(FSItem **table, FSItem *FSItem::*next_field, uint32 hash, FSItem *p)
+{
+	FSItem **link = &table[hash & (fsitem_hash_size - 1)];
+	while (*link)
+		link = &((*link)->*next_field);
+	*link = p;
+	p->*next_field = NULL;
+}
+
+static void unlink_hash(FSItem **table, FSItem *FSItem::*next_field, uint32 hash, FSItem *p)
+{
+	FSItem **link = &table[hash & (fsitem_hash_size - 1)];
+	while (*link) {
+		if (*link == p) {
+			*link = p->*next_field;
+			return;
+		}
+		link = &((*link)->*next_field);
+	}
+}
+
+static void link_fsitem(FSItem *p)
+{
+	link_hash(id_hash, &FSItem::next_id, hash_id(p->id), p);
+	link_hash(name_hash, &FSItem::next_name, hash_name(p->parent, p->name), p);
+	link_hash(guest_hash, &FSItem::next_guest, hash_name(p->parent, p->guest_name), p);
+}
+
+// (Re)allocate hash tables with the given number of buckets and insert all FSItems
+static void rehash_fsitems(uint32 size)
+{
+	delete[] id_hash;
+	delete[] name_hash;
+	delete[] guest_hash;
+	fsitem_hash_size = size;
+	id_hash = new FSItem *[size];
+	name_hash = new FSItem *[size];
+	guest_hash = new FSItem *[size];
+	memset(id_hash, 0, size * sizeof(FSItem *));
+	memset(name_hash, 0, size * sizeof(FSItem *));
+	memset(guest_hash, 0, size * sizeof(FSItem *));
+
+	// Walk the list in creation order to preserve chain order
+	for (FSItem *p = first_fs_item; p; p = p->next)
+		link_fsitem(p);
+	D(bug("FSItem hash tables resized to %d buckets for %d items\n", size, num_fs_items));
+}
+
+// Add new FSItem (already appended to the list) to the hash tables
+static void add_fsitem(FSItem *p)
+{
+	num_fs_items++;
+	if (num_fs_items > fsitem_hash_size)
+		rehash_fsitems(fsitem_hash_size * 2);
+	else
+		link_fsitem(p);
+}
+
+// Exchange CNIDs of two FSItems
+static void swap_fsitem_ids(FSItem *p1, FSItem *p2)
+{
+	unlink_hash(id_hash, &FSItem::next_id, hash_id(p1->id), p1);
+	unlink_hash(id_hash, &FSItem::next_id, hash_id(p2->id), p2);
+	uint32 t = p1->id;
+	p1->id = p2->id;
+	p2->id = t;
+	link_hash(id_hash, &FSItem::next_id, hash_id(p1->id), p1);
+	link_hash(id_hash, &FSItem::next_id, hash_id(p2->id), p2);
+}
+
+
 /*
  *  Find FSItem for given CNID
  */
 
 static FSItem *find_fsitem_by_id(uint32 cnid)
 {
-	FSItem *p = first_fs_item;
+	FSItem *p = id_hash[hash_id(cnid) & (fsitem_hash_size - 1)];
 	while (p) {
 		if (p->id == cnid)
 			return p;
-		p = p->next;
+		p = p->next_id;
 	}
 	return NULL;
 }
@@ -237,9 +370,14 @@ static FSItem *create_fsitem(const char *name, const char *guest_name, FSItem *p
 	p->parent = parent;
 	p->name = new char[strlen(name) + 1];
 	strcpy(p->name, name);
+	p->path = NULL;
 	strncpy(p->guest_name, guest_name, 31);
 	p->guest_name[31] = 0;
 	p->mtime = 0;
+	p->attrs = NULL;
+	p->dir_gen = 0;
+	p->watch = 0;
+	add_fsitem(p);
 	return p;
 }
 
@@ -249,11 +387,11 @@ static FSItem *create_fsitem(const char *name, const char *guest_name, FSItem *p
 
 static FSItem *find_fsitem(const char *name, FSItem *parent)
 {
-	FSItem *p = first_fs_item;
+	FSItem *p = name_hash[hash_name(parent, name) & (fsitem_hash_size - 1)];
 	while (p) {
 		if (p->parent == parent && !strcmp(p->name, name))
 			return p;
-		p = p->next;
+		p = p->next_name;
 	}
 
 	// Not found, construct new FSItem
@@ -266,17 +404,42 @@ static FSItem *find_fsitem(const char *name, FSItem *parent)
 
 static FSItem *find_fsitem_guest(const char *guest_name, FSItem *parent)
 {
-	FSItem *p = first_fs_item;
+	FSItem *p = guest_hash[hash_name(parent, guest_name) & (fsitem_hash_size - 1)];
 	while (p) {
 		if (p->parent == parent && !strcmp(p->guest_name, guest_name))
 			return p;
-		p = p->next;
+		p = p->next_guest;
 	}
 
 	// Not found, construct new FSItem
 	return create_fsitem(macroman_to_host_encoding(guest_name), guest_name, parent);
 }
 
+/*
+ *  Get full host path for given FSItem
+ *  (built once from the parent's path, as the name and parent of an FSItem never change)
+ */
+
+static const char *get_fsitem_path(FSItem *p)
+{
+	if (p->path == NULL) {
+		char path[MAX_PATH_LENGTH];
+		if (p->id == ROOT_PARENT_ID) {
+			path[0] = 0;
+		} else if (p->id == ROOT_ID) {
+			strncpy(path, RootPath, MAX_PATH_LENGTH-1);
+			path[MAX_PATH_LENGTH-1] = 0;
+		} else {
+			strcpy(path, get_fsitem_path(p->parent));
+			add_path_component(path, p->name);
+		}
+		p->path = new char[strlen(path) + 1];
+		strcpy(p->path, path);
+	}
+	return p->path;
+}
+
+
 /*
  *  Get full path (->full_path) for given FSItem
  */
@@ -290,15 +453,7 @@ static void add_path_comp(const char *s)
 
 static void get_path_for_fsitem(FSItem *p)
 {
-	if (p->id == ROOT_PARENT_ID) {
-		full_path[0] = 0;
-	} else if (p->id == ROOT_ID) {
-		strncpy(full_path, RootPath, MAX_PATH_LENGTH-1);
-		full_path[MAX_PATH_LENGTH-1] = 0;
-	} else {
-		get_path_for_fsitem(p->parent);
-		add_path_comp(p->name);
-	}
+	strcpy(full_path, get_fsitem_path(p));
 }
 
 
@@ -319,6 +474,321 @@ static void swap_parent_ids(uint32 parent1, uint32 parent2)
 }
 
 
+/*
+ *  Directory listing cache for indexed catalog queries: the Finder enumerates
+ *  a directory with ioFDirIndex = 1..n, so keep a sorted snapshot of the
+ *  entry names of the most recently enumerated directories instead of
+ *  re-reading the directory for every index
+ */
+
+struct DirListing {
+	FSItem *dir;						// Directory (NULL = unused slot)
+	time_t mtime;						// Modification time of directory when read
+	long mtime_nsec;					// Nanoseconds part of modification time
+	uint32 last_used;					// For LRU replacement
+	std::vector<std::string> entries;	// Sorted entry names
+};
+
+const int NUM_DIR_LISTINGS = 8;
+static DirListing dir_listings[NUM_DIR_LISTINGS];
+static uint32 dir_listing_clock = 0;
+
+// Invalidate cached listing of given directory (after creating/deleting/renaming entries)
+static void invalidate_dir_listing(FSItem *dir)
+{
+	for (int i=0; i<NUM_DIR_LISTINGS; i++) {
+		if (dir_listings[i].dir == dir) {
+			dir_listings[i].dir = NULL;
+			dir_listings[i].entries.clear();
+		}
+	}
+}
+
+static void invalidate_all_dir_listings(void)
+{
+	for (int i=0; i<NUM_DIR_LISTINGS; i++) {
+		dir_listings[i].dir = NULL;
+		std::vector<std::string>().swap(dir_listings[i].entries);
+	}
+}
+
+// Nanoseconds part of modification time, so that changes within the same second are noticed
+static inline long get_mtime_nsec(const struct stat &st)
+{
+#if defined(__linux__)
+	return st.st_mtim.tv_nsec;
+#elif defined __APPLE__ && defined __MACH__
+	return st.st_mtimespec.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+static void process_host_changes(void);
+
+// Get name of nth (1-based) entry of directory
+static int16 get_dir_entry(FSItem *dir, int index, const char *&name)
+{
+	process_host_changes();		// Invalidates listings of watched directories
+
+	const char *path = get_fsitem_path(dir);
+	struct stat st;
+	if (stat(path, &st) < 0 || !S_ISDIR(st.st_mode))
+		return dirNFErr;
+
+	// Look for valid cached listing, otherwise pick least recently used slot
+	DirListing *l = NULL, *victim = &dir_listings[0];
+	for (int i=0; i<NUM_DIR_LISTINGS; i++) {
+		DirListing *c = &dir_listings[i];
+		if (c->dir == dir) {
+			l = c;
+			break;
+		}
+		if (c->last_used < victim->last_used)
+			victim = c;
+	}
+	if (l == NULL || l->mtime != st.st_mtime || l->mtime_nsec != get_mtime_nsec(st)) {
+		if (l == NULL)
+			l = victim;
+		l->dir = NULL;
+		l->entries.clear();
+
+		// Read directory
+		DIR *d = opendir(path);
+		if (d == NULL)
+			return dirNFErr;
+		struct dirent *de;
+		while ((de = readdir(d)) != NULL) {
+			if (de->d_name[0] == '.')
+				continue;	// Suppress names beginning with '.' (MacOS could interpret these as driver names)
+			l->entries.push_back(de->d_name);
+		}
+		closedir(d);
+		std::sort(l->entries.begin(), l->entries.end());
+		l->dir = dir;
+		l->mtime = st.st_mtime;
+		l->mtime_nsec = get_mtime_nsec(st);
+		D(bug("  read listing of %s, %d entries\n", path, int(l->entries.size())));
+	}
+	l->last_used = ++dir_listing_clock;
+
+	if (index < 1 || index > int(l->entries.size()))
+		return fnfErr;
+	name = l->entries[index - 1].c_str();
+	return noErr;
+}
+
+
+/*
+ *  Host attribute cache: GetCatInfo/GetFileInfo need stat(), access() and the
+ *  Finder info and resource fork helpers for every item, which adds up when
+ *  the Finder keeps refreshing a large folder. Attributes are kept for a short
+ *  time; on Linux, directories and their .finf/.rsrc helper directories are
+ *  additionally watched with inotify so host changes invalidate them
+ *  immediately and they can be kept longer.
+ *  Changes made through ExtFS itself invalidate the attributes explicitly.
+ */
+
+const time_t ATTR_CACHE_TIMEOUT = 2;			// Lifetime of cached attributes (seconds)
+const time_t ATTR_CACHE_WATCHED_TIMEOUT = 10;	// Lifetime if parent directory is watched
+
+static uint32 attr_global_gen = 0;				// Incremented to invalidate all cached attributes
+
+#ifdef __linux__
+static int inotify_fd = -1;
+static std::map<int, std::vector<FSItem *> > watched_dirs;	// inotify watch descriptor -> directories whose items it covers
+static std::list<FSItem *> watch_order;		// Watched directories, oldest first
+
+// Maximum number of watched directories; each takes up to three of the
+// user's inotify watches (fs.inotify.max_user_watches), so the oldest
+// watches are removed and their directories fall back to the timeouts
+const size_t MAX_WATCHED_DIRS = 512;
+
+const uint32 WATCH_MASK = IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+// Add inotify watch on host path for the items of directory; returns watch descriptor
+static int add_dir_watch(FSItem *dir, const char *path)
+{
+	int wd = inotify_add_watch(inotify_fd, path, WATCH_MASK);
+	if (wd > 0) {
+		std::vector<FSItem *> &dirs = watched_dirs[wd];
+		if (std::find(dirs.begin(), dirs.end(), dir) == dirs.end())
+			dirs.push_back(dir);
+	}
+	return wd;
+}
+
+// Remove all inotify watches of directory
+static void remove_dir_watches(FSItem *dir)
+{
+	std::map<int, std::vector<FSItem *> >::iterator it = watched_dirs.begin();
+	while (it != watched_dirs.end()) {
+		std::vector<FSItem *> &dirs = it->second;
+		dirs.erase(std::remove(dirs.begin(), dirs.end(), dir), dirs.end());
+		if (dirs.empty()) {
+			inotify_rm_watch(inotify_fd, it->first);
+			watched_dirs.erase(it++);
+		} else
+			++it;
+	}
+	dir->watch = 0;
+	dir->dir_gen++;		// Attributes were cached with the longer timeout
+}
+
+// Helper directories holding the Finder info and resource forks of the items of a directory (see extfs_unix.cpp)
+static const char *helper_dir_names[] = {".finf", ".rsrc"};
+
+// Watch helper directories of directory
+static void watch_helper_dirs(FSItem *dir)
+{
+	for (int i = 0; i < int(sizeof(helper_dir_names) / sizeof(helper_dir_names[0])); i++) {
+		char path[MAX_PATH_LENGTH];
+		strncpy(path, get_fsitem_path(dir), MAX_PATH_LENGTH-1);
+		path[MAX_PATH_LENGTH-1] = 0;
+		add_path_component(path, helper_dir_names[i]);
+		add_dir_watch(dir, path);	// Fails if the helper directory doesn't exist (yet)
+	}
+}
+
+static bool is_helper_dir_name(const char *name)
+{
+	for (int i = 0; i < int(sizeof(helper_dir_names) / sizeof(helper_dir_names[0])); i++)
+		if (strcmp(name, helper_dir_names[i]) == 0)
+			return true;
+	return false;
+}
+
+// Watch parent directory of item for host changes
+static void watch_parent_dir(FSItem *p)
+{
+	FSItem *dir = p->parent;
+	if (inotify_fd < 0 || dir->watch != 0 || dir->id == ROOT_PARENT_ID)
+		return;
+	if (watch_order.size() >= MAX_WATCHED_DIRS) {
+		remove_dir_watches(watch_order.front());
+		watch_order.pop_front();
+	}
+	dir->watch = add_dir_watch(dir, get_fsitem_path(dir));
+	if (dir->watch > 0) {
+		watch_helper_dirs(dir);
+		watch_order.push_back(dir);
+	} else
+		dir->watch = -1;
+}
+
+// Process pending inotify events
+static void process_host_changes(void)
+{
+	if (inotify_fd < 0)
+		return;
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t len;
+	while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+		for (char *ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event *)ptr)->len) {
+			const struct inotify_event *ev = (const struct inotify_event *)ptr;
+			if (ev->mask & IN_Q_OVERFLOW) {
+				attr_global_gen++;
+				invalidate_all_dir_listings();
+				continue;
+			}
+			std::map<int, std::vector<FSItem *> >::iterator it = watched_dirs.find(ev->wd);
+			if (it == watched_dirs.end())
+				continue;
+			std::vector<FSItem *> dirs = it->second;
+			if (ev->mask & IN_IGNORED)		// Watch removed (directory deleted, moved or unmounted)
+				watched_dirs.erase(it);
+			for (size_t i = 0; i < dirs.size(); i++) {
+				FSItem *dir = dirs[i];
+				D(bug("host change in %s (%s), mask %08x\n", dir->name, ev->len ? ev->name : "", ev->mask));
+				dir->dir_gen++;		// Invalidates attributes of all entries
+				if (dir->attrs)
+					dir->attrs->valid = false;
+				if (dir->watch != ev->wd)
+					continue;
+				if (ev->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_IGNORED))
+					invalidate_dir_listing(dir);
+				if (ev->mask & IN_IGNORED) {
+					remove_dir_watches(dir);	// Helper directory watches
+					watch_order.remove(dir);
+				} else if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && ev->len && is_helper_dir_name(ev->name))
+					watch_helper_dirs(dir);
+			}
+		}
+	}
+}
+#else
+static inline void watch_parent_dir(FSItem *p) { }
+static void process_host_changes(void) { }
+#endif
+
+// Invalidate cached attributes of item
+static void invalidate_attrs(FSItem *p)
+{
+	if (p && p->attrs)
+		p->attrs->valid = false;
+}
+
+// Invalidate cached attributes of item open in given FCB
+static void invalidate_fcb_attrs(uint32 fcb)
+{
+	invalidate_attrs(find_fsitem_by_id(ReadMacInt32(fcb + fcbFlNm)));
+}
+
+// Entries of directory were created, deleted or renamed through ExtFS
+static void dir_changed(FSItem *dir)
+{
+	invalidate_dir_listing(dir);
+	invalidate_attrs(dir);
+	dir->dir_gen++;
+}
+
+// Get attributes of item; returns NULL and sets errno if the item doesn't exist
+static const FSItemAttrs *get_item_attrs(FSItem *p)
+{
+	process_host_changes();
+
+	time_t now = time(NULL);
+	FSItem *dir = p->parent;
+	FSItemAttrs *a = p->attrs;
+	if (a && a->valid && a->dir_gen == dir->dir_gen && a->global_gen == attr_global_gen
+	 && now >= a->time && now - a->time < (dir->watch > 0 ? ATTR_CACHE_WATCHED_TIMEOUT : ATTR_CACHE_TIMEOUT))
+		return a;
+
+	const char *path = get_fsitem_path(p);
+	struct stat st;
+	if (stat(path, &st) < 0) {
+		invalidate_attrs(p);
+		return NULL;
+	}
+	if (a == NULL)
+		a = p->attrs = new FSItemAttrs;
+
+	a->is_dir = S_ISDIR(st.st_mode);
+	a->locked = access(path, W_OK) != 0;
+	a->size = st.st_size;
+	a->mtime = st.st_mtime;
+#if defined(__BEOS__) || defined(WIN32)
+	a->crtime = TimeToMacTime(st.st_crtime);
+#elif defined __APPLE__ && defined __MACH__
+	a->crtime = get_creation_time(path);
+#else
+	a->crtime = 0;
+#endif
+	get_finfo(path, fs_data + fsReturn, fs_data + fsReturn + SIZEOF_FInfo, a->is_dir);
+	Mac2Host_memcpy(a->finfo, fs_data + fsReturn, SIZEOF_FInfo);
+	Mac2Host_memcpy(a->fxinfo, fs_data + fsReturn + SIZEOF_FInfo, SIZEOF_FXInfo);
+	a->rf_size = a->is_dir ? 0 : get_rfork_size(path);
+
+	watch_parent_dir(p);
+
+	a->time = now;
+	a->dir_gen = dir->dir_gen;
+	a->global_gen = attr_global_gen;
+	a->valid = true;
+	return a;
+}
+
+
 /*
  *  String handling functions
  */
@@ -405,6 +875,13 @@ void ExtFSInit(void)
 	// System specific initialization
 	extfs_init();
 
+#ifdef __linux__
+	// Set up host change notification for attribute cache
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotify_fd < 0)
+		D(bug("inotify_init1 failed, attribute cache uses timeouts only\n"));
+#endif
+
 	// Get file system and volume name
 	cstr2pstr(FS_NAME, GetString(STR_EXTFS_NAME));
 	cstr2pstr(VOLUME_NAME, GetString(STR_EXTFS_VOLUME_NAME));
@@ -418,7 +895,11 @@ void ExtFSInit(void)
 	p->parent = NULL;
 	p->name = new char[1];
 	p->name[0] = 0;
+	p->path = NULL;
 	p->guest_name[0] = 0;
+	p->attrs = NULL;
+	p->dir_gen = 0;
+	p->watch = 0;
 
 	// Create root FSItem
 	p = new FSItem;
@@ -431,8 +912,16 @@ void ExtFSInit(void)
 	const char *volume_name = GetString(STR_EXTFS_VOLUME_NAME);
 	p->name = new char[strlen(volume_name) + 1];
 	strcpy(p->name, volume_name);
+	p->path = NULL;
 	strncpy(p->guest_name, host_encoding_to_macroman(p->name), 32);
 	p->guest_name[31] = 0;
+	p->attrs = NULL;
+	p->dir_gen = 0;
+	p->watch = 0;
+
+	// Set up hash tables
+	num_fs_items = 2;
+	rehash_fsitems(FSITEM_HASH_MIN_SIZE);
 
 	// Find path for root
 	*RootPath = 0;
@@ -460,10 +949,30 @@ void ExtFSExit(void)
 	while (p) {
 		next = p->next;
 		delete[] p->name;
+		delete[] p->path;
+		delete p->attrs;
 		delete p;
 		p = next;
 	}
 	first_fs_item = last_fs_item = NULL;
+	invalidate_all_dir_listings();
+
+#ifdef __linux__
+	// Stop host change notification
+	if (inotify_fd >= 0) {
+		close(inotify_fd);
+		inotify_fd = -1;
+	}
+	watched_dirs.clear();
+	watch_order.clear();
+#endif
+
+	// Delete hash tables
+	delete[] id_hash;
+	delete[] name_hash;
+	delete[] guest_hash;
+	id_hash = name_hash = guest_hash = NULL;
+	fsitem_hash_size = num_fs_items = 0;
 
 	// System specific deinitialization
 	extfs_exit();
@@ -1276,59 +1785,42 @@ static int16 fs_get_file_info(uint32 pb, bool hfs, uint32 dirID)
 		get_path_for_fsitem(p);
 
 		// Look for nth item in directory and add name to path
-		DIR *d = opendir(full_path);
-		if (d == NULL)
-			return dirNFErr;
-		struct dirent *de = NULL;
-		for (int i=0; i<dir_index; i++) {
-read_next_de:
-			de = readdir(d);
-			if (de == NULL) {
-				closedir(d);
-				return fnfErr;
-			}
-			if (de->d_name[0] == '.')
-				goto read_next_de;	// Suppress names beginning with '.' (MacOS could interpret these as driver names)
-			//!! suppress directories
-		}
-		add_path_comp(de->d_name);
+		const char *name;
+		if ((result = get_dir_entry(p, dir_index, name)) != noErr)
+			return result;
+		//!! suppress directories
+		add_path_comp(name);
 
 		// Get FSItem for queried item
-		fs_item = find_fsitem(de->d_name, p);
-		closedir(d);
+		fs_item = find_fsitem(name, p);
 	}
 
-	// Get stats
-	struct stat st;
-	if (stat(full_path, &st))
+	// Get attributes
+	const FSItemAttrs *attrs = get_item_attrs(fs_item);
+	if (attrs == NULL)
 		return fnfErr;
-	if (S_ISDIR(st.st_mode))
+	if (attrs->is_dir)
 		return fnfErr;
 
-	// Fill in struct from fs_item and stats
+	// Fill in struct from fs_item and attributes
 	if (ReadMacInt32(pb + ioNamePtr))
 		cstr2pstr((char *)Mac2HostAddr(ReadMacInt32(pb + ioNamePtr)), fs_item->guest_name);
 	WriteMacInt16(pb + ioFRefNum, 0);
-	WriteMacInt8(pb + ioFlAttrib, access(full_path, W_OK) == 0 ? 0 : faLocked);
+	WriteMacInt8(pb + ioFlAttrib, attrs->locked ? faLocked : 0);
 	WriteMacInt32(pb + ioDirID, fs_item->id);
+	WriteMacInt32(pb + ioFlCrDat, attrs->crtime);
+	WriteMacInt32(pb + ioFlMdDat, TimeToMacTime(attrs->mtime));
 
-#if defined(__BEOS__) || defined(WIN32)
-	WriteMacInt32(pb + ioFlCrDat, TimeToMacTime(st.st_crtime));
-#elif defined __APPLE__ && defined __MACH__
-	WriteMacInt32(pb + ioFlCrDat, get_creation_time(full_path));
-#else
-	WriteMacInt32(pb + ioFlCrDat, 0);
-#endif
-	WriteMacInt32(pb + ioFlMdDat, TimeToMacTime(st.st_mtime));
-
-	get_finfo(full_path, pb + ioFlFndrInfo, hfs ? pb + ioFlXFndrInfo : 0, false);
+	Host2Mac_memcpy(pb + ioFlFndrInfo, attrs->finfo, SIZEOF_FInfo);
+	if (hfs)
+		Host2Mac_memcpy(pb + ioFlXFndrInfo, attrs->fxinfo, SIZEOF_FXInfo);
 
 	WriteMacInt16(pb + ioFlStBlk, 0);
-	uint32 file_size = (uint32) st.st_size;
+	uint32 file_size = (uint32) attrs->size;
 	WriteMacInt32(pb + ioFlLgLen, file_size);
 	WriteMacInt32(pb + ioFlPyLen, (file_size | (AL_BLK_SIZE - 1)) + 1);
 	WriteMacInt16(pb + ioFlRStBlk, 0);
-	uint32 rf_size = get_rfork_size(full_path);
+	uint32 rf_size = attrs->rf_size;
 	WriteMacInt32(pb + ioFlRLgLen, rf_size);
 	WriteMacInt32(pb + ioFlRPyLen, (rf_size | (AL_BLK_SIZE - 1)) + 1);
 
@@ -1360,6 +1852,7 @@ static int16 fs_set_file_info(uint32 pb, bool hfs, uint32 dirID)
 
 	// Set Finder info
 	set_finfo(full_path, pb + ioFlFndrInfo, hfs ? pb + ioFlXFndrInfo : 0, false);
+	invalidate_attrs(fs_item);
 
 	//!! times
 	return noErr;
@@ -1400,51 +1893,33 @@ static int16 fs_get_cat_info(uint32 pb)
 		get_path_for_fsitem(p);
 
 		// Look for nth item in directory and add name to path
-		DIR *d = opendir(full_path);
-		if (d == NULL)
-			return dirNFErr;
-		struct dirent *de = NULL;
-		for (int i=0; i<dir_index; i++) {
-read_next_de:
-			de = readdir(d);
-			if (de == NULL) {
-				closedir(d);
-				return fnfErr;
-			}
-			if (de->d_name[0] == '.')
-				goto read_next_de;	// Suppress names beginning with '.' (MacOS could interpret these as driver names)
-		}
-		add_path_comp(de->d_name);
+		const char *name;
+		if ((result = get_dir_entry(p, dir_index, name)) != noErr)
+			return result;
+		add_path_comp(name);
 
 		// Get FSItem for queried item
-		fs_item = find_fsitem(de->d_name, p);
-		closedir(d);
+		fs_item = find_fsitem(name, p);
 	}
 	D(bug("  path %s\n", full_path));
 
-	// Get stats
-	struct stat st;
-	if (stat(full_path, &st) < 0)
+	// Get attributes
+	const FSItemAttrs *attrs = get_item_attrs(fs_item);
+	if (attrs == NULL)
 		return errno2oserr();
-	if (dir_index == -1 && !S_ISDIR(st.st_mode))
+	if (dir_index == -1 && !attrs->is_dir)
 		return dirNFErr;
 
-	// Fill in struct from fs_item and stats
+	// Fill in struct from fs_item and attributes
 	if (ReadMacInt32(pb + ioNamePtr))
 		cstr2pstr((char *)Mac2HostAddr(ReadMacInt32(pb + ioNamePtr)), fs_item->guest_name);
 	WriteMacInt16(pb + ioFRefNum, 0);
-	WriteMacInt8(pb + ioFlAttrib, (S_ISDIR(st.st_mode) ? faIsDir : 0) | (access(full_path, W_OK) == 0 ? 0 : faLocked));
+	WriteMacInt8(pb + ioFlAttrib, (attrs->is_dir ? faIsDir : 0) | (attrs->locked ? faLocked : 0));
 	WriteMacInt8(pb + ioACUser, 0);
 	WriteMacInt32(pb + ioDirID, fs_item->id);
 	WriteMacInt32(pb + ioFlParID, fs_item->parent_id);
-#if defined(__BEOS__) || defined(WIN32)
-	WriteMacInt32(pb + ioFlCrDat, TimeToMacTime(st.st_crtime));
-#elif defined __APPLE__ && defined __MACH__
-	WriteMacInt32(pb + ioFlCrDat, get_creation_time(full_path));
-#else
-	WriteMacInt32(pb + ioFlCrDat, 0);
-#endif
-	time_t mtime = st.st_mtime;
+	WriteMacInt32(pb + ioFlCrDat, attrs->crtime);
+	time_t mtime = attrs->mtime;
 	bool cached = true;
 	if (mtime > fs_item->mtime) {
 		fs_item->mtime = mtime;
@@ -1453,9 +1928,10 @@ read_next_de:
 	WriteMacInt32(pb + ioFlMdDat, TimeToMacTime(mtime));
 	WriteMacInt32(pb + ioFlBkDat, 0);
 
-	get_finfo(full_path, pb + ioFlFndrInfo, pb + ioFlXFndrInfo, S_ISDIR(st.st_mode));
+	Host2Mac_memcpy(pb + ioFlFndrInfo, attrs->finfo, SIZEOF_FInfo);
+	Host2Mac_memcpy(pb + ioFlXFndrInfo, attrs->fxinfo, SIZEOF_FXInfo);
 
-	if (S_ISDIR(st.st_mode)) {
+	if (attrs->is_dir) {
 
 		// Determine number of files in directory (cached)
 		int count;
@@ -1481,11 +1957,11 @@ read_next_de:
 		WriteMacInt16(pb + ioDrNmFls, count);
 	} else {
 		WriteMacInt16(pb + ioFlStBlk, 0);
-		uint32 file_size = (uint32) st.st_size;
+		uint32 file_size = (uint32) attrs->size;
 		WriteMacInt32(pb + ioFlLgLen, file_size);
 		WriteMacInt32(pb + ioFlPyLen, (file_size | (AL_BLK_SIZE - 1)) + 1);
 		WriteMacInt16(pb + ioFlRStBlk, 0);
-		uint32 rf_size = get_rfork_size(full_path);
+		uint32 rf_size = attrs->rf_size;
 		WriteMacInt32(pb + ioFlRLgLen, rf_size);
 		WriteMacInt32(pb + ioFlRPyLen, (rf_size | (AL_BLK_SIZE - 1)) + 1);
 		WriteMacInt32(pb + ioFlClpSiz, 0);
@@ -1511,6 +1987,7 @@ static int16 fs_set_cat_info(uint32 pb)
 
 	// Set Finder info
 	set_finfo(full_path, pb + ioFlFndrInfo, pb + ioFlXFndrInfo, S_ISDIR(st.st_mode));
+	invalidate_attrs(fs_item);
 
 	//!! times
 	return noErr;
@@ -1625,13 +2102,12 @@ static int16 fs_close(uint32 pb)
 	// Close file
 	if (ReadMacInt8(fcb + fcbFlags) & fcbResourceMask) {
 		FSItem *item = find_fsitem_by_id(ReadMacInt32(fcb + fcbFlNm));
-		if (item) {
-			get_path_for_fsitem(item);
-			close_rfork(full_path, fd);
-		}
+		if (item)
+			close_rfork(get_fsitem_path(item), fd);
 	} else
 		close(fd);
 	WriteMacInt32(fcb + fcbCatPos, (uint32)-1);
+	invalidate_fcb_attrs(fcb);
 
 	// Release FCB
 	D(bug("  releasing FCB\n"));
@@ -1749,6 +2225,7 @@ static int16 fs_set_eof(uint32 pb)
 	uint32 size = ReadMacInt32(pb + ioMisc);
 	if (ftruncate(fd, size) < 0)
 		return errno2oserr();
+	invalidate_fcb_attrs(fcb);
 
 	// Adjust FCBs
 	WriteMacInt32(fcb + fcbEOF, size);
@@ -1931,6 +2408,7 @@ static int16 fs_write(uint32 pb)
 	// Write
 	ssize_t actual = extfs_write(fd, Mac2HostAddr(ReadMacInt32(pb + ioBuffer)), ReadMacInt32(pb + ioReqCount));
 	int16 write_err = errno2oserr();
+	invalidate_fcb_attrs(fcb);
 	D(bug("  actual %d\n", actual));
 	WriteMacInt32(pb + ioActCount, actual >= 0 ? actual : 0);
 	uint32 pos = (uint32) lseek(fd, 0, SEEK_CUR);
@@ -1963,6 +2441,7 @@ static int16 fs_create(uint32 pb, uint32 dirID)
 		return errno2oserr();
 	else {
 		close(fd);
+		dir_changed(fs_item->parent);
 		return noErr;
 	}
 }
@@ -1986,6 +2465,7 @@ static int16 fs_dir_create(uint32 pb)
 	if (mkdir(full_path, 0777) < 0)
 		return errno2oserr();
 	else {
+		dir_changed(fs_item->parent);
 		WriteMacInt32(pb + ioDirID, fs_item->id);
 		return noErr;
 	}
@@ -2005,8 +2485,10 @@ static int16 fs_delete(uint32 pb, uint32 dirID)
 	// Delete file
 	if (!extfs_remove(full_path))
 		return errno2oserr();
-	else
+	else {
+		dir_changed(fs_item->parent);
 		return noErr;
+	}
 }
 
 // Rename file/directory
@@ -2041,11 +2523,11 @@ static int16 fs_rename(uint32 pb, uint32 dirID)
 	if (!extfs_rename(old_path, full_path))
 		return errno2oserr();
 	else {
+		dir_changed(fs_item->parent);
+
 		// The ID of the old file/dir has to stay the same, so we swap the IDs of the FSItems
 		swap_parent_ids(fs_item->id, new_item->id);
-		uint32 t = fs_item->id;
-		fs_item->id = new_item->id;
-		new_item->id = t;
+		swap_fsitem_ids(fs_item, new_item);
 		return noErr;
 	}
 }
@@ -2085,13 +2567,14 @@ static int16 fs_cat_move(uint32 pb)
 	if (!extfs_rename(old_path, full_path))
 		return errno2oserr();
 	else {
+		dir_changed(fs_item->parent);
+		dir_changed(new_dir_item);
+
 		// The ID of the old file/dir has to stay the same, so we swap the IDs of the FSItems
 		FSItem *new_item = find_fsitem(fs_item->name, new_dir_item);
 		if (new_item) {
 			swap_parent_ids(fs_item->id, new_item->id);
-			uint32 t = fs_item->id;
-			fs_item->id = new_item->id;
-			new_item->id = t;
+			swap_fsitem_ids(fs_item, new_item);
 		}
 		return noErr;
 	}
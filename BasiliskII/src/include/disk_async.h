@@ -0,0 +1,235 @@
+/*
+ *  disk_async.h - Asynchronous Prime() requests of the disk drivers
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DISK_ASYNC_H
+#define DISK_ASYNC_H
+
+// Note: this file is #include'd in disk.cpp and sony.cpp, each driver has its own I/O thread
+
+// Asynchronous I/O request (the Device Manager only passes one Prime() at a time to the driver)
+struct disk_io_request {
+	void *fh;			// File handle
+	void *buffer;		// Host address of data buffer
+	loff_t position;	// Byte offset in file
+	size_t length;		// Number of bytes to transfer
+	size_t actual;		// Number of bytes transferred
+	bool write;			// Flag: write request
+	uint32 pb, dce;		// Mac addresses of ParamBlock and DCE
+	int16 result;		// Result code passed to IODone
+	bool pending;		// Flag: request not yet completed to Mac OS (emulator thread only)
+	bool queued;		// Flag: request waiting for/being processed by I/O thread
+	bool done;			// Flag: I/O thread finished request
+};
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+
+// Deferred Task structure for completing asynchronous Prime() requests
+enum {
+	asyncdtCode = 20,	// DT code is stored here
+	asyncdtResult = 30,
+	asyncdtDCE = 34,
+	SIZEOF_asyncdt = 38
+};
+
+class disk_async_io {
+public:
+	disk_async_io() : dt(0), thread_active(false), thread_cancel(false)
+	{
+		pthread_mutex_init(&lock, NULL);
+		pthread_cond_init(&cond, NULL);
+		req.pending = req.queued = req.done = false;
+	}
+
+	// Start I/O thread if enabled in the prefs (in DiskInit()/SonyInit())
+	void start(void)
+	{
+		if (!PrefsFindBool("diskasync"))
+			return;
+		thread_cancel = false;
+		thread_active = (pthread_create(&thread, NULL, io_func, this) == 0);
+		D(bug(" I/O thread installed\n"));
+	}
+
+	// Stop I/O thread
+	void stop(void)
+	{
+		if (!thread_active)
+			return;
+		pthread_mutex_lock(&lock);
+		thread_cancel = true;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&lock);
+		pthread_join(thread, NULL);
+		thread_active = false;
+	}
+
+	// Allocate Deferred Task structure for asynchronous requests (in Open())
+	void open(void)
+	{
+		dt = 0;
+		if (!thread_active)
+			return;
+		wait_idle();
+		req.pending = req.done = false;
+
+		M68kRegisters r;
+		r.d[0] = SIZEOF_asyncdt;
+		Execute68kTrap(0xa71e, &r);		// NewPtrSysClear()
+		dt = r.a[0];
+		D(bug(" io_dt %08lx\n", dt));
+		if (dt) {
+			WriteMacInt16(dt + qType, dtQType);
+			WriteMacInt32(dt + dtAddr, dt + asyncdtCode);
+			WriteMacInt32(dt + dtParam, dt + asyncdtResult);
+															// Deferred function for signalling that Prime is complete (pointer to mydtResult in a1)
+			WriteMacInt16(dt + asyncdtCode, 0x2019);			// move.l	(a1)+,d0	(result)
+			WriteMacInt16(dt + asyncdtCode + 2, 0x2251);		// move.l	(a1),a1		(dce)
+			WriteMacInt32(dt + asyncdtCode + 4, 0x207808fc);	// move.l	JIODone,a0
+			WriteMacInt16(dt + asyncdtCode + 8, 0x4ed0);		// jmp		(a0)
+		}
+	}
+
+	// Flag: asynchronous requests are supported
+	bool enabled(void) const { return dt != 0; }
+
+	// Wait until the I/O thread is no longer accessing any drive
+	void wait_idle(void)
+	{
+		pthread_mutex_lock(&lock);
+		while (req.queued)
+			pthread_cond_wait(&cond, &lock);
+		pthread_mutex_unlock(&lock);
+	}
+
+	// Pass asynchronous queued Prime() request to the I/O thread, returns false if it has to be performed synchronously
+	bool queue(uint32 pb, uint32 dce, void *fh, void *buffer, loff_t position, size_t length, bool write)
+	{
+		uint16 trap = ReadMacInt16(pb + ioTrap);
+		if (!dt || !(trap & (1 << asyncTrpBit)) || (trap & (1 << noQueueBit)) || req.pending)
+			return false;
+		pthread_mutex_lock(&lock);
+		req.fh = fh;
+		req.buffer = buffer;
+		req.position = position;
+		req.length = length;
+		req.write = write;
+		req.pb = pb;
+		req.dce = dce;
+		req.pending = req.queued = true;
+		req.done = false;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&lock);
+		return true;
+	}
+
+	// Complete finished request to Mac OS: update ParamBlock and DCE and activate Deferred
+	// Task to call IODone (in the INTFLAG_DISK interrupt), returns NULL if no request finished
+	const disk_io_request *complete(void)
+	{
+		if (!req.pending)
+			return NULL;
+		pthread_mutex_lock(&lock);
+		bool done = req.done;
+		pthread_mutex_unlock(&lock);
+		if (!done)
+			return NULL;
+
+		// Update ParamBlock and DCE
+		req.result = noErr;
+		if (req.actual != req.length)
+			req.result = req.write ? writErr : readErr;
+		else {
+			WriteMacInt32(req.pb + ioActCount, req.actual);
+			WriteMacInt32(req.dce + dCtlPosition, ReadMacInt32(req.dce + dCtlPosition) + req.actual);
+		}
+
+		// Call IODone from Deferred Task
+		WriteMacInt32(dt + asyncdtResult, (int32)req.result);
+		WriteMacInt32(dt + asyncdtDCE, req.dce);
+#ifdef SHEEPSHAVER
+		Enqueue(dt, 0xd92);
+#else
+		EnqueueMac(dt, 0xd92);
+#endif
+		req.pending = req.done = false;
+		return &req;
+	}
+
+private:
+	// I/O thread, performs queued Prime() requests
+	static void *io_func(void *arg)
+	{
+		disk_async_io *io = (disk_async_io *)arg;
+		disk_io_request &req = io->req;
+		pthread_mutex_lock(&io->lock);
+		for (;;) {
+			while (!req.queued && !io->thread_cancel)
+				pthread_cond_wait(&io->cond, &io->lock);
+			if (!req.queued)
+				break;
+			pthread_mutex_unlock(&io->lock);
+
+			size_t actual;
+			if (req.write)
+				actual = Sys_write(req.fh, req.buffer, req.position, req.length);
+			else
+				actual = Sys_read(req.fh, req.buffer, req.position, req.length);
+
+			pthread_mutex_lock(&io->lock);
+			req.actual = actual;
+			req.queued = false;
+			req.done = true;
+			pthread_cond_broadcast(&io->cond);
+
+			// Complete request in DiskIOInterrupt()/SonyIOInterrupt()
+			SetInterruptFlag(INTFLAG_DISK);
+			TriggerInterrupt();
+		}
+		pthread_mutex_unlock(&io->lock);
+		return NULL;
+	}
+
+	disk_io_request req;
+	uint32 dt;				// Mac address of Deferred Task (0 = only synchronous operation)
+	bool thread_active;		// Flag: I/O thread installed
+	bool thread_cancel;		// Flag: cancel I/O thread
+	pthread_t thread;		// I/O thread
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+#else
+
+// Without threads, all requests are performed synchronously
+class disk_async_io {
+public:
+	void start(void) { }
+	void stop(void) { }
+	void open(void) { }
+	bool enabled(void) const { return false; }
+	void wait_idle(void) { }
+	bool queue(uint32 pb, uint32 dce, void *fh, void *buffer, loff_t position, size_t length, bool write) { return false; }
+	const disk_io_request *complete(void) { return NULL; }
+};
+
+#endif
+
+#endif
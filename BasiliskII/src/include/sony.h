@@ -34,6 +34,7 @@ extern void SonyInit(void);
 extern void SonyExit(void);
 
 extern void SonyInterrupt(void);
+extern void SonyIOInterrupt(void);
 
 extern bool SonyMountVolume(void *fh);
 
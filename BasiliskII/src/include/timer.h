@@ -34,6 +34,12 @@ extern void Microseconds(uint32 &hi, uint32 &lo);
 
 extern uint32 TimerDateTime(void);
 
+#ifdef PRECISE_TIMING_TIMERFD
+// Call func periodically from the timer thread, until it returns false
+extern bool TimerStartTick(bool (*func)(void), uint32 period_usec);
+extern void TimerStopTick(void);
+#endif
+
 // System specific and internal functions/data
 extern void timer_current_time(tm_time_t &t);
 extern void timer_add_time(tm_time_t &res, tm_time_t a, tm_time_t b);
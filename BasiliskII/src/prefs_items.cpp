@@ -57,6 +57,7 @@ prefs_desc common_prefs_items[] = {
 	{"cpu", TYPE_INT32, false,        "CPU type (0 = 68000, 1 = 68010 etc.)"},
 	{"fpu", TYPE_BOOLEAN, false,      "enable FPU emulation"},
 	{"nocdrom", TYPE_BOOLEAN, false,  "don't install CD-ROM driver"},
+	{"diskasync", TYPE_BOOLEAN, false,  "complete disk I/O asynchronously in a host thread"},
 	{"nosound", TYPE_BOOLEAN, false,  "don't enable sound output"},
 	{"noclipconversion", TYPE_BOOLEAN, false, "don't convert clipboard contents"},
 	{"nogui", TYPE_BOOLEAN, false,    "disable GUI"},
@@ -67,6 +68,7 @@ prefs_desc common_prefs_items[] = {
 	{"jitlazyflush", TYPE_BOOLEAN, false, "enable lazy invalidation of translation cache"},
 	{"jitinline", TYPE_BOOLEAN, false,   "enable translation through constant jumps"},
 	{"jitblacklist", TYPE_STRING, false, "blacklist opcodes from translation"},
+	{"jitprofile", TYPE_BOOLEAN, false,  "collect per-block JIT execution profile"},
 	{"keyboardtype", TYPE_INT32, false, "hardware keyboard type"},
 	{"keycodes", TYPE_BOOLEAN, false, "use keycodes rather than keysyms to decode keyboard"},
 	{"keycodefile", TYPE_STRING, false, "path of keycode translation file"},
@@ -84,6 +86,7 @@ prefs_desc common_prefs_items[] = {
 	{"host_domain", TYPE_STRING, true,	"handle DNS requests for this domain on the host (slirp only)"},
 	{"title", TYPE_STRING, false,	"window title"},
 	{"sound_buffer", TYPE_INT32, false,	"sound buffer length"},
+	{"sound_latency", TYPE_INT32, false,	"number of sound buffers to fill ahead"},
 	{"name_encoding", TYPE_INT32, false,	"file name encoding"},
 	{"delay", TYPE_INT32, false,	"additional delay [uS] every 64k instructions"},
 	{"init_grab", TYPE_BOOLEAN, false,	"initially grabbing mouse"},
@@ -110,7 +113,9 @@ void AddPrefsDefaults(void)
 	PrefsAddInt32("displaycolordepth", 0);
 	PrefsAddBool("fpu", false);
 	PrefsAddBool("nocdrom", false);
+	PrefsAddBool("diskasync", false);
 	PrefsAddBool("nosound", false);
+	PrefsAddInt32("sound_latency", 2);
 	PrefsAddBool("noclipconversion", false);
 	PrefsAddBool("nogui", false);
 	
@@ -122,6 +127,7 @@ void AddPrefsDefaults(void)
 	PrefsAddInt32("jitcachesize", 8192);
 	PrefsAddBool("jitlazyflush", true);
 	PrefsAddBool("jitinline", true);
+	PrefsAddBool("jitprofile", false);
 #else
 	PrefsAddBool("jit", false);
 #endif
@@ -29,6 +29,21 @@ int slirp_select_fill(int *pnfds,
 
 void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds);
 
+/* Event-driven alternative to slirp_select_fill()/slirp_select_poll().
+ * slirp_pollfds_fill() calls UPDATE for each socket whose wanted events
+ * changed (OLD_EVENTS == 0: add, NEW_EVENTS == 0: remove), and returns
+ * the timeout in microseconds. Events that occurred are then reported
+ * with slirp_pollfds_set_revents() using the OPAQUE value passed to
+ * UPDATE, before calling slirp_pollfds_poll(). */
+#define SLIRP_POLL_IN	1
+#define SLIRP_POLL_OUT	2
+#define SLIRP_POLL_PRI	4
+
+typedef void (*slirp_update_fd_fn)(int fd, int old_events, int new_events, void *opaque);
+int slirp_pollfds_fill(slirp_update_fd_fn update);
+void slirp_pollfds_set_revents(void *opaque, int revents);
+void slirp_pollfds_poll(void);
+
 void slirp_input(const uint8 *pkt, int pkt_len);
 
 /* you must provide the following functions: */
@@ -27,9 +27,6 @@ struct timeval tt;
 FILE *lfd;
 struct ex_list *exec_list;
 
-/* XXX: suppress those select globals */
-fd_set *global_readfds, *global_writefds, *global_xfds;
-
 char slirp_hostname[33];
 
 #ifdef _WIN32
@@ -194,19 +191,17 @@ static void updtime(void)
 }
 #endif
 
-int slirp_select_fill(int *pnfds, 
-					  fd_set *readfds, fd_set *writefds, fd_set *xfds)
+/*
+ * Compute the events to wait for on each socket and report them
+ * through SET_EVENTS, returns the timeout to use in microseconds
+ */
+static int slirp_fill(void (*set_events)(struct socket *so, int events, void *opaque),
+					  void *opaque)
 {
     struct socket *so, *so_next;
-    int nfds;
+    int events;
     int timeout, tmp_time;
 
-    /* fail safe */
-    global_readfds = NULL;
-    global_writefds = NULL;
-    global_xfds = NULL;
-    
-    nfds = *pnfds;
 	/*
 	 * First, TCP sockets
 	 */
@@ -232,15 +227,16 @@ int slirp_select_fill(int *pnfds,
 			 * NOFDREF can include still connecting to local-host,
 			 * newly socreated() sockets etc. Don't want to select these.
 	 		 */
-			if (so->so_state & SS_NOFDREF || so->s == -1)
+			if (so->so_state & SS_NOFDREF || so->s == -1) {
+			   set_events(so, 0, opaque);
 			   continue;
+			}
 			
 			/*
 			 * Set for reading sockets which are accepting
 			 */
 			if (so->so_state & SS_FACCEPTCONN) {
-                                FD_SET(so->s, readfds);
-				UPD_NFDS(so->s);
+				set_events(so, SLIRP_POLL_IN, opaque);
 				continue;
 			}
 			
@@ -248,8 +244,7 @@ int slirp_select_fill(int *pnfds,
 			 * Set for writing sockets which are connecting
 			 */
 			if (so->so_state & SS_ISFCONNECTING) {
-				FD_SET(so->s, writefds);
-				UPD_NFDS(so->s);
+				set_events(so, SLIRP_POLL_OUT, opaque);
 				continue;
 			}
 			
@@ -257,20 +252,17 @@ int slirp_select_fill(int *pnfds,
 			 * Set for writing if we are connected, can send more, and
 			 * we have something to send
 			 */
-			if (CONN_CANFSEND(so) && so->so_rcv.sb_cc) {
-				FD_SET(so->s, writefds);
-				UPD_NFDS(so->s);
-			}
+			events = 0;
+			if (CONN_CANFSEND(so) && so->so_rcv.sb_cc)
+				events |= SLIRP_POLL_OUT;
 			
 			/*
 			 * Set for reading (and urgent data) if we are connected, can
 			 * receive more, and we have room for it XXX /2 ?
 			 */
-			if (CONN_CANFRCV(so) && (so->so_snd.sb_cc < (so->so_snd.sb_datalen/2))) {
-				FD_SET(so->s, readfds);
-				FD_SET(so->s, xfds);
-				UPD_NFDS(so->s);
-			}
+			if (CONN_CANFRCV(so) && (so->so_snd.sb_cc < (so->so_snd.sb_datalen/2)))
+				events |= SLIRP_POLL_IN | SLIRP_POLL_PRI;
+			set_events(so, events, opaque);
 		}
 		
 		/*
@@ -300,10 +292,10 @@ int slirp_select_fill(int *pnfds,
 			 * if the packets needed to be fragmented
 			 * (XXX <= 4 ?)
 			 */
-			if ((so->so_state & SS_ISFCONNECTED) && so->so_queued <= 4) {
-				FD_SET(so->s, readfds);
-				UPD_NFDS(so->s);
-			}
+			if (so->s != -1 && (so->so_state & SS_ISFCONNECTED) && so->so_queued <= 4)
+				set_events(so, SLIRP_POLL_IN, opaque);
+			else
+				set_events(so, 0, opaque);
 		}
 	}
 	
@@ -338,7 +330,6 @@ int slirp_select_fill(int *pnfds,
 			   timeout = tmp_time;
 		}
 	}
-	*pnfds = nfds;
 
 	/*
 	 * Adjust the timeout to make the minimum timeout
@@ -350,15 +341,14 @@ int slirp_select_fill(int *pnfds,
 	return timeout;
 }	
 
-void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
+/*
+ * Process the events recorded in so_revents of each socket
+ */
+static void slirp_poll(void)
 {
     struct socket *so, *so_next;
     int ret;
 
-    global_readfds = readfds;
-    global_writefds = writefds;
-    global_xfds = xfds;
-
 	/* Update time */
 	updtime();
 	
@@ -388,27 +378,30 @@ void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
 			so_next = so->so_next;
 			
 			/*
-			 * FD_ISSET is meaningless on these sockets
+			 * so_revents is meaningless on these sockets
 			 * (and they can crash the program)
 			 */
-			if (so->so_state & SS_NOFDREF || so->s == -1)
+			if (so->so_state & SS_NOFDREF || so->s == -1) {
+			   so->so_revents = 0;
 			   continue;
+			}
 			
 			/*
 			 * Check for URG data
 			 * This will soread as well, so no need to
-			 * test for readfds below if this succeeds
+			 * test for reading below if this succeeds
 			 */
-			if (FD_ISSET(so->s, xfds))
+			if (so->so_revents & SLIRP_POLL_PRI)
 			   sorecvoob(so);
 			/*
 			 * Check sockets for reading
 			 */
-			else if (FD_ISSET(so->s, readfds)) {
+			else if (so->so_revents & SLIRP_POLL_IN) {
 				/*
 				 * Check for incoming connections
 				 */
 				if (so->so_state & SS_FACCEPTCONN) {
+					so->so_revents = 0;
 					tcp_connect(so);
 					continue;
 				} /* else */
@@ -422,7 +415,8 @@ void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
 			/*
 			 * Check sockets for writing
 			 */
-			if (FD_ISSET(so->s, writefds)) {
+			if (so->so_revents & SLIRP_POLL_OUT) {
+			  so->so_revents = 0;
 			  /*
 			   * Check for non-blocking, still-connecting sockets
 			   */
@@ -456,6 +450,8 @@ void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
 			   * a window probe to get things going again
 			   */
 			}
+			else
+			  so->so_revents = 0;
 			
 			/*
 			 * Probe a still-connecting, non-blocking socket
@@ -501,9 +497,12 @@ void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
 		for (so = udb.so_next; so != &udb; so = so_next) {
 			so_next = so->so_next;
 			
-			if (so->s != -1 && FD_ISSET(so->s, readfds)) {
+			if (so->s != -1 && (so->so_revents & SLIRP_POLL_IN)) {
+                            so->so_revents = 0;
                             sorecvfrom(so);
                         }
+                        else
+                            so->so_revents = 0;
 		}
 	}
 	
@@ -512,15 +511,106 @@ void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
 	 */
 	if (if_queued && link_up)
 	   if_start();
+}
 
-	/* clear global file descriptor sets.
-	 * these reside on the stack in vl.c
-	 * so they're unusable if we're not in
-	 * slirp_select_fill or slirp_select_poll.
-	 */
-	 global_readfds = NULL;
-	 global_writefds = NULL;
-	 global_xfds = NULL;
+/*
+ * select() interface
+ */
+struct select_fds {
+	fd_set *readfds, *writefds, *xfds;
+	int nfds;
+};
+
+static void select_set_events(struct socket *so, int events, void *opaque)
+{
+	struct select_fds *fds = (struct select_fds *)opaque;
+	int nfds = fds->nfds;
+
+	if (events & SLIRP_POLL_IN)
+		FD_SET(so->s, fds->readfds);
+	if (events & SLIRP_POLL_OUT)
+		FD_SET(so->s, fds->writefds);
+	if (events & SLIRP_POLL_PRI)
+		FD_SET(so->s, fds->xfds);
+	if (events)
+		UPD_NFDS(so->s);
+	fds->nfds = nfds;
+}
+
+int slirp_select_fill(int *pnfds, 
+					  fd_set *readfds, fd_set *writefds, fd_set *xfds)
+{
+	struct select_fds fds;
+	int timeout;
+
+	fds.readfds = readfds;
+	fds.writefds = writefds;
+	fds.xfds = xfds;
+	fds.nfds = *pnfds;
+	timeout = slirp_fill(select_set_events, &fds);
+	*pnfds = fds.nfds;
+	return timeout;
+}
+
+static void select_get_revents(struct socket *head, fd_set *readfds, fd_set *writefds, fd_set *xfds)
+{
+	struct socket *so;
+
+	for (so = head->so_next; so != head; so = so->so_next) {
+		so->so_revents = 0;
+		if (so->so_state & SS_NOFDREF || so->s == -1)
+			continue;
+		if (FD_ISSET(so->s, readfds))
+			so->so_revents |= SLIRP_POLL_IN;
+		if (FD_ISSET(so->s, writefds))
+			so->so_revents |= SLIRP_POLL_OUT;
+		if (FD_ISSET(so->s, xfds))
+			so->so_revents |= SLIRP_POLL_PRI;
+	}
+}
+
+void slirp_select_poll(fd_set *readfds, fd_set *writefds, fd_set *xfds)
+{
+	if (link_up) {
+		select_get_revents(&tcb, readfds, writefds, xfds);
+		select_get_revents(&udb, readfds, writefds, xfds);
+	}
+	slirp_poll();
+}
+
+/*
+ * Event-driven interface, sockets are not limited to FD_SETSIZE
+ */
+static void pollfds_set_events(struct socket *so, int events, void *opaque)
+{
+	slirp_update_fd_fn update = *(slirp_update_fd_fn *)opaque;
+
+	if (so->s == -1) {
+		/* Closed descriptors were dropped from the poll set already */
+		so->so_poll_events = 0;
+		return;
+	}
+	if (events != so->so_poll_events) {
+		update(so->s, so->so_poll_events, events, so);
+		so->so_poll_events = events;
+	}
+}
+
+int slirp_pollfds_fill(slirp_update_fd_fn update)
+{
+	return slirp_fill(pollfds_set_events, &update);
+}
+
+void slirp_pollfds_set_revents(void *opaque, int revents)
+{
+	struct socket *so = (struct socket *)opaque;
+
+	so->so_revents = revents & so->so_poll_events;
+}
+
+void slirp_pollfds_poll(void)
+{
+	slirp_poll();
 }
 
 #define ETH_ALEN 6
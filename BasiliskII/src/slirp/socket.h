@@ -51,6 +51,9 @@ struct socket {
   struct sbuf so_rcv;		/* Receive buffer */
   struct sbuf so_snd;		/* Send buffer */
   void * extra;			/* Extra pointer */
+
+  int	so_poll_events;		/* SLIRP_POLL_* events waited for */
+  int	so_revents;		/* SLIRP_POLL_* events that occurred */
 };
 
 
@@ -48,6 +48,8 @@ using std::vector;
 #define DEBUG 0
 #include "debug.h"
 
+#include "disk_async.h"
+
 
 // Check for inserted disks by polling?
 #ifdef AMIGA
@@ -129,6 +131,9 @@ uint32 SonyDriveIconAddr;
 // Flag: Control(accRun) has been called, interrupt routine is now active
 static bool acc_run_called = false;
 
+// Asynchronous Prime() requests
+static disk_async_io async_io;
+
 
 /*
  *  Get reference to drive info or drives.end() if not found
@@ -168,6 +173,10 @@ void SonyInit(void)
 		if (fh)
 			drives.push_back(sony_drive_info(fh, SysIsReadOnly(fh)));
 	}
+
+	// Start I/O thread for asynchronous requests
+	if (!drives.empty())
+		async_io.start();
 }
 
 
@@ -177,6 +186,9 @@ void SonyInit(void)
 
 void SonyExit(void)
 {
+	// Stop I/O thread
+	async_io.stop();
+
 	drive_vec::iterator info, end = drives.end();
 	for (info = drives.begin(); info != end; ++info)
 		info->close_fh();
@@ -195,6 +207,7 @@ bool SonyMountVolume(void *fh)
 		++info;
 	if (info != end) {
 		D(bug("Looking for disk in drive %d\n", info->num));
+		async_io.wait_idle();
 		if (SysIsDiskInserted(info->fh)) {
 			info->read_only = SysIsReadOnly(info->fh);
 			WriteMacInt8(info->status + dsDiskInPlace, 1);	// Inserted removable disk
@@ -266,6 +279,9 @@ int16 SonyOpen(uint32 pb, uint32 dce)
 	WriteMacInt16(dce + dCtlQHdr + qFlags, (ReadMacInt16(dce + dCtlQHdr + qFlags) & 0xff00) | 3);	// Version number, must be >=3 or System 8 will replace us
 	acc_run_called = false;
 
+	// Allocate Deferred Task structure for asynchronous requests
+	async_io.open();
+
 	// Install driver again with refnum -2 (HD20)
 	uint32 utab = ReadMacInt32(0x11c);
 	WriteMacInt32(utab + 4, ReadMacInt32(utab + 16));
@@ -346,8 +362,17 @@ int16 SonyPrime(uint32 pb, uint32 dce)
 	if ((length & 0x1ff) || (position & 0x1ff))
 		return set_dsk_err(paramErr);
 
+	bool write = (ReadMacInt16(pb + ioTrap) & 0xff) != aRdCmd;
+	if (write && info->read_only)
+		return set_dsk_err(wPrErr);
+
+	// Asynchronous queued request? Then pass it to the I/O thread and return "pending"
+	if (acc_run_called && async_io.queue(pb, dce, info->fh, buffer, position, length, write))
+		return 1;
+	async_io.wait_idle();
+
 	size_t actual = 0;
-	if ((ReadMacInt16(pb + ioTrap) & 0xff) == aRdCmd) {
+	if (!write) {
 
 		// Read
 		actual = Sys_read(info->fh, buffer, position, length);
@@ -362,8 +387,6 @@ int16 SonyPrime(uint32 pb, uint32 dce)
 	} else {
 
 		// Write
-		if (info->read_only)
-			return set_dsk_err(wPrErr);
 		actual = Sys_write(info->fh, buffer, position, length);
 		if (actual != length)
 			return set_dsk_err(writErr);
@@ -416,6 +439,7 @@ int16 SonyControl(uint32 pb, uint32 dce)
 			break;
 
 		case 6:			// Format disk
+			async_io.wait_idle();
 			if (info->read_only) {
 				err = wPrErr;
 			} else if (ReadMacInt8(info->status + dsDiskInPlace) > 0) {
@@ -426,6 +450,7 @@ int16 SonyControl(uint32 pb, uint32 dce)
 			break;
 
 		case 7:			// Eject
+			async_io.wait_idle();
 			if (ReadMacInt8(info->status + dsDiskInPlace) > 0) {
 				SysEject(info->fh);
 				WriteMacInt8(info->status + dsDiskInPlace, 0);
@@ -558,3 +583,25 @@ void SonyInterrupt(void)
 
 	mount_mountable_volumes();
 }
+
+
+/*
+ *  Sony I/O interrupt - asynchronous Prime() completed, activate Deferred Task to call IODone
+ */
+
+void SonyIOInterrupt(void)
+{
+	const disk_io_request *req = async_io.complete();
+	if (req == NULL)
+		return;
+	D(bug("SonyIOInterrupt\n"));
+
+	if (req->result == noErr && !req->write) {
+
+		// Clear TagBuf
+		WriteMacInt32(0x2fc, 0);
+		WriteMacInt32(0x300, 0);
+		WriteMacInt32(0x304, 0);
+	}
+	set_dsk_err(req->result);
+}
@@ -0,0 +1,111 @@
+/*
+ *  audio_mix_bench.cpp - SDL audio mixing benchmark
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ *  Checks that the SSE2 kernels match the scalar ones and compares their speed
+ */
+
+#include "sysdeps.h"
+#include "timer.h"
+
+#include "../SDL/audio_mix.h"
+
+#include <stdlib.h>
+
+const int MIX_MAXVOLUME = 128;		// SDL_MIX_MAXVOLUME
+
+typedef void (*mix_func)(uint8 *, const uint8 *, int, const uint8 *, int, int);
+
+// Compare mix with mix_scalar for all volume pairs, dst and ref start out equal
+// so the byte a 16 bit kernel leaves alone at an odd length is compared too
+static int check_mix(mix_func mix, mix_func mix_scalar, const uint8 *a, const uint8 *b, uint8 *dst, uint8 *ref, int len)
+{
+	int errors = 0;
+	for (int vol_a = 0; vol_a <= MIX_MAXVOLUME; vol_a += 32)
+		for (int vol_b = 0; vol_b <= MIX_MAXVOLUME; vol_b += 32) {
+			memset(dst, 0x55, len + 16);
+			memset(ref, 0x55, len + 16);
+			mix(dst, a, vol_a, b, vol_b, len);
+			mix_scalar(ref, a, vol_a, b, vol_b, len);
+			if (memcmp(dst, ref, len + 16))
+				errors++;
+		}
+	return errors;
+}
+
+int main(void)
+{
+	const int BLOCK_SIZE = 4096 * 4;	// 4096 stereo 16 bit frames
+	const int N_BLOCKS = 20000;
+	static uint8 a[BLOCK_SIZE + 16], b[BLOCK_SIZE + 16], dst[BLOCK_SIZE + 16], ref[BLOCK_SIZE + 16];
+	for (int i = 0; i < BLOCK_SIZE + 16; i++) {
+		a[i] = rand();
+		b[i] = rand();
+	}
+
+#if !defined(__SSE2__)
+	printf("SSE2 not enabled, both versions are scalar\n");
+#endif
+	int total_errors = 0;
+
+	// Stereo expansion, compared with a plain byte loop
+	int errors = 0;
+	for (int len = 0; len <= 80; len += 2) {
+		memset(dst, 0x55, len + 16);
+		expand_mono_u8(dst, a + 1, len);
+		for (int i = 0; i < len; i++)
+			if (dst[i] != a[1 + i / 2])
+				errors++;
+		for (int i = len; i < len + 16; i++)
+			if (dst[i] != 0x55)
+				errors++;
+	}
+	printf("expand_mono_u8: %d mismatches\n", errors);
+	total_errors += errors;
+
+	for (int u8 = 0; u8 < 2; u8++) {
+		mix_func mix = u8 ? mix_u8 : mix_s16msb;
+		mix_func mix_scalar = u8 ? mix_u8_scalar : mix_s16msb_scalar;
+
+		// Results must be identical, for lengths below the 16 byte SSE2 width,
+		// with a tail after the SSE2 loop, odd lengths, unaligned sources and
+		// saturation
+		errors = 0;
+		for (int len = 0; len <= 48; len++)
+			errors += check_mix(mix, mix_scalar, a, b, dst, ref, len);
+		errors += check_mix(mix, mix_scalar, a, b, dst, ref, BLOCK_SIZE - 7);
+		errors += check_mix(mix, mix_scalar, a, b, dst, ref, BLOCK_SIZE - 6);
+		errors += check_mix(mix, mix_scalar, a + 1, b + 3, dst + 1, ref + 1, BLOCK_SIZE - 1);
+		total_errors += errors;
+
+		uint64 t0 = GetTicks_usec();
+		for (int i = 0; i < N_BLOCKS; i++)
+			mix(dst, a, 100, b, 60, BLOCK_SIZE);
+		uint64 t1 = GetTicks_usec();
+		for (int i = 0; i < N_BLOCKS; i++)
+			mix_scalar(ref, a, 100, b, 60, BLOCK_SIZE);
+		uint64 t2 = GetTicks_usec();
+
+		printf("%s: %d mismatches, SSE2 %.2f us, scalar %.2f us per %d byte block (%.1fx)\n",
+			u8 ? "mix_u8" : "mix_s16msb", errors, double(t1 - t0) / N_BLOCKS, double(t2 - t1) / N_BLOCKS,
+			BLOCK_SIZE, double(t2 - t1) / (t1 - t0));
+	}
+	return total_errors != 0;
+}
@@ -0,0 +1,75 @@
+/*
+ *  bench_stubs.cpp - Emulator functions needed by the modules under benchmark
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ *  The benchmarks run the code of one module without a ROM or a running
+ *  68k CPU, so none of these is expected to be called with real work
+ */
+
+#include "sysdeps.h"
+#include "cpu_emulation.h"
+#include "main.h"
+#include "macos_util.h"
+#include "prefs.h"
+#include "user_strings.h"
+
+#include <stdlib.h>
+
+#if DIRECT_ADDRESSING
+uintptr MEMBaseDiff;
+#endif
+
+void Execute68k(uint32 addr, M68kRegisters *r)
+{
+	fprintf(stderr, "Execute68k(%08x) called from benchmark\n", addr);
+	abort();
+}
+
+void Execute68kTrap(uint16 trap, M68kRegisters *r)
+{
+	fprintf(stderr, "Execute68kTrap(%04x) called from benchmark\n", trap);
+	abort();
+}
+
+int FindFreeDriveNumber(int num)
+{
+	return num;
+}
+
+// Plain UTC conversion, without the "yearofs"/"dayofs" prefs
+uint32 TimeToMacTime(time_t t)
+{
+	return uint32(t + 2082844800);
+}
+
+time_t MacTimeToTime(uint32 t)
+{
+	return time_t(t) - 2082844800;
+}
+
+const char *PrefsFindString(const char *name, int index)
+{
+	return NULL;
+}
+
+const char *GetString(int num)
+{
+	return "";
+}
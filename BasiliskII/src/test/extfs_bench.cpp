@@ -0,0 +1,133 @@
+/*
+ *  extfs_bench.cpp - ExtFS FSItem lookup benchmark
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ *  Populates 100k FSItems and compares the lookup latency of the hash
+ *  tables with the walk of the FSItem list that was used before them
+ */
+
+// The benchmark needs the static functions of extfs.cpp
+#include "../extfs.cpp"
+
+#include "timer.h"
+
+// Lookups as done before the hash tables (list walk)
+static FSItem *list_find_fsitem_by_id(uint32 cnid)
+{
+	FSItem *p = first_fs_item;
+	while (p) {
+		if (p->id == cnid)
+			return p;
+		p = p->next;
+	}
+	return NULL;
+}
+
+static FSItem *list_find_fsitem(const char *name, FSItem *parent)
+{
+	FSItem *p = first_fs_item;
+	while (p) {
+		if (p->parent == parent && !strcmp(p->name, name))
+			return p;
+		p = p->next;
+	}
+	return NULL;
+}
+
+static FSItem *list_find_fsitem_guest(const char *guest_name, FSItem *parent)
+{
+	FSItem *p = first_fs_item;
+	while (p) {
+		if (p->parent == parent && !strcmp(p->guest_name, guest_name))
+			return p;
+		p = p->next;
+	}
+	return NULL;
+}
+
+int main(void)
+{
+	const int N_ITEMS = 100000;
+	const int N_DIRS = 100;
+	const int N_LIST_LOOKUPS = 2000;	// The list walk is too slow for N_ITEMS lookups
+	char name[32];
+
+	ExtFSInit();
+	FSItem *root = find_fsitem_by_id(ROOT_ID);
+	FSItem *dirs[N_DIRS];
+	for (int i = 0; i < N_DIRS; i++) {
+		sprintf(name, "dir%d", i);
+		dirs[i] = find_fsitem(name, root);
+	}
+
+	uint64 t0 = GetTicks_usec();
+	for (int i = 0; i < N_ITEMS; i++) {
+		sprintf(name, "file%d", i);
+		find_fsitem(name, dirs[i % N_DIRS]);
+	}
+	uint64 t1 = GetTicks_usec();
+	printf("%d items created in %.1f ms\n", num_fs_items, (t1 - t0) / 1000.0);
+
+	// Look up the same pseudo-random items both ways, the results must match
+	uint32 sum = 0;
+	int errors = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		const bool list = pass == 0;
+		const int n = list ? N_LIST_LOOKUPS : N_ITEMS;
+
+		t0 = GetTicks_usec();
+		for (int i = 0; i < n; i++) {
+			uint32 cnid = fsUsrCNID + N_DIRS + (i * 7919) % N_ITEMS;
+			FSItem *p = list ? list_find_fsitem_by_id(cnid) : find_fsitem_by_id(cnid);
+			if (p == NULL || p->id != cnid)
+				errors++;
+			else
+				sum += p->id;
+		}
+		t1 = GetTicks_usec();
+		for (int i = 0; i < n; i++) {
+			int item = (i * 7919) % N_ITEMS;
+			sprintf(name, "file%d", item);
+			FSItem *p = list ? list_find_fsitem(name, dirs[item % N_DIRS]) : find_fsitem(name, dirs[item % N_DIRS]);
+			if (p->id != uint32(fsUsrCNID + N_DIRS + item))
+				errors++;
+			sum += p->id;
+		}
+		uint64 t2 = GetTicks_usec();
+		for (int i = 0; i < n; i++) {
+			int item = (i * 7919) % N_ITEMS;
+			sprintf(name, "file%d", item);
+			FSItem *p = list ? list_find_fsitem_guest(name, dirs[item % N_DIRS]) : find_fsitem_guest(name, dirs[item % N_DIRS]);
+			if (p->id != uint32(fsUsrCNID + N_DIRS + item))
+				errors++;
+			sum += p->id;
+		}
+		uint64 t3 = GetTicks_usec();
+
+		printf("%s (%d lookups each):\n", list ? "Before, FSItem list walk" : "After, hash tables", n);
+		printf("  find_fsitem_by_id: %.1f ns per lookup\n", (t1 - t0) * 1000.0 / n);
+		printf("  find_fsitem:       %.1f ns per lookup\n", (t2 - t1) * 1000.0 / n);
+		printf("  find_fsitem_guest: %.1f ns per lookup\n", (t3 - t2) * 1000.0 / n);
+	}
+	printf("%d errors (%08x)\n", errors, sum);
+
+	ExtFSExit();
+	return errors != 0;
+}
@@ -0,0 +1,96 @@
+/*
+ *  timer_bench.cpp - Time Manager stress benchmark
+ *
+ *  Basilisk II (C) 1997-2008 Christian Bauer
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ *  1000 tasks re-prime themselves with random delays of 0.5-5ms, like the
+ *  timer functions of sound and network drivers do. The tasks have no timer
+ *  function, the benchmark re-primes the ones TimerInterrupt() found expired.
+ *  Needs a DIRECT_ADDRESSING build.
+ */
+
+// The benchmark needs the static data of timer.cpp
+#include "../timer.cpp"
+
+#include <stdlib.h>
+
+static volatile bool bench_interrupt = false;
+
+void SetInterruptFlag(uint32 flag)
+{
+	bench_interrupt = true;
+}
+
+void TriggerInterrupt(void)
+{
+	// The main loop polls bench_interrupt
+}
+
+int main(void)
+{
+	const int N_TASKS = 1000;
+	const int TASK_SIZE = 32;
+	const uint64 RUN_TIME = 3000000;	// usec
+
+	// Mac memory for the TMTasks
+	static uint8 mem[N_TASKS * TASK_SIZE + 0x1000];
+	MEMBaseDiff = (uintptr)mem;
+	const uint32 task_base = 0x1000;
+
+	TimerInit();
+	for (int i = 0; i < N_TASKS; i++) {
+		uint32 tm = task_base + i * TASK_SIZE;
+		WriteMacInt32(tm + tmAddr, 0);
+		InsTime(tm, 0xa058);	// InsXTime
+		WriteMacInt32(tm + tmWakeUp, 0);
+		PrimeTime(tm, -(500 + rand() % 4500));
+	}
+
+	// Serve timer interrupts
+	uint32 interrupts = 0, calls = 0;
+	uint64 busy = 0;
+	uint64 start = GetTicks_usec();
+	uint64 now = start;
+	while (now - start < RUN_TIME) {
+		if (bench_interrupt) {
+			bench_interrupt = false;
+			TimerInterrupt();
+			for (size_t i = 0; i < tmExpired.size(); i++)
+				PrimeTime(tmExpired[i], -(500 + rand() % 4500));
+			interrupts++;
+			calls += tmExpired.size();
+			uint64 t = now;
+			now = GetTicks_usec();
+			busy += now - t;
+		} else
+			now = GetTicks_usec();
+	}
+
+	uint64 t0 = GetTicks_usec();
+	for (int i = 0; i < N_TASKS; i++)
+		RmvTime(task_base + i * TASK_SIZE);
+	uint64 t1 = GetTicks_usec();
+	TimerExit();
+
+	printf("%d tasks: %u task calls in %u interrupts in %.1f s (%.0f expected)\n",
+		N_TASKS, calls, interrupts, RUN_TIME / 1e6, N_TASKS * RUN_TIME / 2750.0);
+	printf("%.2f us Time Manager CPU time per task call\n", calls ? double(busy) / calls : 0.0);
+	printf("RmvTime() of all tasks: %.2f ms\n", (t1 - t0) / 1000.0);
+	return 0;
+}
@@ -34,6 +34,20 @@
 #include <mach/mach.h>
 #endif
 
+#ifdef PRECISE_TIMING_TIMERFD
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+#ifndef NO_STD_NAMESPACE
+using std::vector;
+#endif
+
 #define DEBUG 0
 #include "debug.h"
 
@@ -54,10 +68,18 @@ enum {	// TMTask struct
 struct TMDesc {
 	uint32 task;		// Mac address of associated TMTask
 	tm_time_t wakeup;	// Time this task is scheduled for execution
-	TMDesc *next;
+	int heap_index;		// Position in tmDescHeap, -1 if not scheduled
+	TMDesc *next;		// Next descriptor in hash chain
 };
 
-static TMDesc *tmDescList;
+// Descriptors are hashed by TMTask address, the scheduled ones are also
+// kept in a binary min-heap ordered by wakeup time
+const int TMDESC_HASH_SIZE = 256;	// must be a power of 2
+static TMDesc *tmDescHash[TMDESC_HASH_SIZE];
+static vector<TMDesc *> tmDescHeap;
+
+// TMTasks found expired by TimerInterrupt()
+static vector<uint32> tmExpired;
 
 #if PRECISE_TIMING
 #ifdef PRECISE_TIMING_BEOS
@@ -86,31 +108,109 @@ static tm_time_t wakeup_time = wakeup_time_max;
 static semaphore_t wakeup_time_sem;
 static void *timer_func(void *arg);
 #endif
+#ifdef PRECISE_TIMING_TIMERFD
+static pthread_t timer_thread;
+static bool timer_thread_active = false;
+static int timer_epoll_fd = -1;				// epoll instance of timer thread
+static int timer_fd = -1;					// timerfd armed with wakeup time
+static int tick_fd = -1;					// Periodic timerfd for TimerStartTick()
+static tm_time_t wakeup_time_max = { 0x7fffffff, 999999999 };
+static uint64 wakeup_time_ns = 0;			// Armed wakeup time, for statistics
+static bool (*tick_func)(void) = NULL;		// Periodic function
+static uint64 tick_period_ns;				// Period of tick_func
+static uint64 tick_next_ns;					// Next deadline of tick_func
+static pthread_mutex_t tick_lock = PTHREAD_MUTEX_INITIALIZER;
+static void *timer_func(void *arg);
+
+// Histograms of timer thread wakeup latency, for debugging
+const int JITTER_BUCKETS = 8;
+static const int jitter_bucket_usec[JITTER_BUCKETS - 1] = { 10, 20, 50, 100, 200, 500, 1000 };
+static uint32 timer_jitter[JITTER_BUCKETS];
+static uint32 tick_jitter[JITTER_BUCKETS];
+static uint32 tick_overruns = 0;
+#endif
+static tm_time_t wakeup_time_set;	// Wakeup time last handed to timer thread
 #endif
 
 
-inline static void free_desc(TMDesc *desc)
+/*
+ *  Heap of scheduled tasks
+ */
+
+static inline void heap_place(TMDesc *desc, int i)
+{
+	tmDescHeap[i] = desc;
+	desc->heap_index = i;
+}
+
+static void heap_sift_up(TMDesc *desc, int i)
+{
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (timer_cmp_time(tmDescHeap[parent]->wakeup, desc->wakeup) <= 0)
+			break;
+		heap_place(tmDescHeap[parent], i);
+		i = parent;
+	}
+	heap_place(desc, i);
+}
+
+static void heap_sift_down(TMDesc *desc, int i)
 {
-	if (desc == tmDescList) {
-		tmDescList = desc->next;
+	const int n = tmDescHeap.size();
+	for (;;) {
+		int child = 2 * i + 1;
+		if (child >= n)
+			break;
+		if (child + 1 < n && timer_cmp_time(tmDescHeap[child + 1]->wakeup, tmDescHeap[child]->wakeup) < 0)
+			child++;
+		if (timer_cmp_time(desc->wakeup, tmDescHeap[child]->wakeup) <= 0)
+			break;
+		heap_place(tmDescHeap[child], i);
+		i = child;
+	}
+	heap_place(desc, i);
+}
+
+// Insert descriptor into heap or move it after its wakeup time changed
+static void heap_schedule(TMDesc *desc)
+{
+	if (desc->heap_index < 0) {
+		tmDescHeap.push_back(desc);
+		heap_sift_up(desc, tmDescHeap.size() - 1);
 	} else {
-		for (TMDesc *d = tmDescList; d; d = d->next) {
-			if (d->next == desc) {
-				d->next = desc->next;
-				break;
-			}
-		}
+		heap_sift_up(desc, desc->heap_index);
+		heap_sift_down(desc, desc->heap_index);
 	}
-	delete desc;
 }
 
+static void heap_unschedule(TMDesc *desc)
+{
+	int i = desc->heap_index;
+	if (i < 0)
+		return;
+	desc->heap_index = -1;
+	TMDesc *last = tmDescHeap.back();
+	tmDescHeap.pop_back();
+	if (last != desc) {
+		heap_sift_up(last, i);
+		heap_sift_down(last, last->heap_index);
+	}
+}
+
+
 /*
  *  Find descriptor associated with given TMTask
  */
 
+static inline TMDesc **desc_hash_slot(uint32 tm)
+{
+	return &tmDescHash[((tm >> 2) ^ (tm >> 10)) & (TMDESC_HASH_SIZE - 1)];
+}
+
 inline static TMDesc *find_desc(uint32 tm)
 {
-	TMDesc *desc = tmDescList;
+	TMDesc *desc = *desc_hash_slot(tm);
 	while (desc) {
 		if (desc->task == tm) {
 			return desc;
@@ -120,6 +220,18 @@ inline static TMDesc *find_desc(uint32 tm)
 	return NULL;
 }
 
+inline static void free_desc(TMDesc *desc)
+{
+	heap_unschedule(desc);
+	for (TMDesc **d = desc_hash_slot(desc->task); *d; d = &(*d)->next) {
+		if (*d == desc) {
+			*d = desc->next;
+			break;
+		}
+	}
+	delete desc;
+}
+
 
 /*
  *  Enqueue task in Time Manager queue
@@ -256,6 +368,150 @@ static void timer_thread_resume(void)
 }
 #endif
 
+#ifdef PRECISE_TIMING_TIMERFD
+static inline uint64 timespec_to_ns(const struct timespec &t)
+{
+	return (uint64)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+static inline void ns_to_timespec(struct timespec &t, uint64 ns)
+{
+	t.tv_sec = ns / 1000000000;
+	t.tv_nsec = ns % 1000000000;
+}
+
+// Account wakeup latency relative to given deadline
+static void record_jitter(uint32 *histogram, uint64 deadline_ns)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64 late_usec = (int64)(timespec_to_ns(now) - deadline_ns) / 1000;
+	int i = 0;
+	while (i < JITTER_BUCKETS - 1 && late_usec >= jitter_bucket_usec[i])
+		i++;
+	histogram[i]++;
+}
+
+static void print_jitter(const char *name, const uint32 *histogram)
+{
+	D(bug("%s wakeup latency:", name));
+	for (int i = 0; i < JITTER_BUCKETS - 1; i++)
+		D(bug(" <%dus %u", jitter_bucket_usec[i], histogram[i]));
+	D(bug(" more %u\n", histogram[JITTER_BUCKETS - 1]));
+}
+
+// Close timer thread file descriptors
+static void timer_thread_close(void)
+{
+	if (timer_epoll_fd >= 0) {
+		close(timer_epoll_fd);
+		timer_epoll_fd = -1;
+	}
+	if (timer_fd >= 0) {
+		close(timer_fd);
+		timer_fd = -1;
+	}
+	if (tick_fd >= 0) {
+		close(tick_fd);
+		tick_fd = -1;
+	}
+}
+
+// Initialize timer thread
+static bool timer_thread_init(void)
+{
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	timer_epoll_fd = epoll_create(2);
+	if (timer_fd < 0 || tick_fd < 0 || timer_epoll_fd < 0)
+		goto error;
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = timer_fd;
+	if (epoll_ctl(timer_epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0)
+		goto error;
+	ev.data.fd = tick_fd;
+	if (epoll_ctl(timer_epoll_fd, EPOLL_CTL_ADD, tick_fd, &ev) < 0)
+		goto error;
+
+	if (pthread_create(&timer_thread, NULL, timer_func, NULL) == 0)
+		return true;
+
+error:
+	timer_thread_close();
+	return false;
+}
+
+// Kill timer thread
+static void timer_thread_kill(void)
+{
+	pthread_cancel(timer_thread);
+	pthread_join(timer_thread, NULL);
+	timer_thread_close();
+}
+#endif
+
+
+/*
+ *  Set wakeup time of timer thread to that of the earliest scheduled task
+ */
+
+#if PRECISE_TIMING
+static void set_wakeup_time(bool force)
+{
+	// Unless forced, only wake up the thread if it has to trigger earlier.
+	// If it triggers too early, TimerInterrupt() finds nothing expired and
+	// forces the update.
+	tm_time_t next = tmDescHeap.empty() ? wakeup_time_max : tmDescHeap[0]->wakeup;
+	if (!force && timer_cmp_time(next, wakeup_time_set) >= 0)
+		return;
+	wakeup_time_set = next;
+
+#ifdef PRECISE_TIMING_TIMERFD
+	// Rearming the timerfd is enough, the timer thread keeps waiting on it
+	struct itimerspec its;
+	memset(&its, 0, sizeof(its));
+	if (timer_cmp_time(next, wakeup_time_max) < 0)
+		its.it_value = next;
+	__atomic_store_n(&wakeup_time_ns, timespec_to_ns(next), __ATOMIC_RELAXED);
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+#else
+#if PRECISE_TIMING_BEOS
+	while (acquire_sem(wakeup_time_sem) == B_INTERRUPTED) ;
+	suspend_thread(timer_thread);
+#endif
+#if PRECISE_TIMING_MACH
+	semaphore_wait(wakeup_time_sem);
+	thread_suspend(timer_thread);
+#endif
+#if PRECISE_TIMING_POSIX
+	pthread_mutex_lock(&wakeup_time_lock);
+	timer_thread_suspend();
+#endif
+	wakeup_time = next;
+#if PRECISE_TIMING_BEOS
+	release_sem(wakeup_time_sem);
+	thread_info info;
+	do {
+		resume_thread(timer_thread);			// This will unblock the thread
+		get_thread_info(timer_thread, &info);
+	} while (info.state == B_THREAD_SUSPENDED);	// Sometimes, resume_thread() doesn't work (BeOS bug?)
+#endif
+#if PRECISE_TIMING_MACH
+	semaphore_signal(wakeup_time_sem);
+	thread_abort(timer_thread);
+	thread_resume(timer_thread);
+#endif
+#if PRECISE_TIMING_POSIX
+	pthread_mutex_unlock(&wakeup_time_lock);
+	timer_thread_resume();
+	assert(suspend_count == 0);
+#endif
+#endif
+}
+#endif
+
 
 /*
  *  Initialize Time Manager
@@ -279,7 +535,7 @@ void TimerInit(void)
 
 	pthread_create(&pthread, NULL, &timer_func, NULL);
 #endif
-#ifdef PRECISE_TIMING_POSIX
+#if defined(PRECISE_TIMING_POSIX) || defined(PRECISE_TIMING_TIMERFD)
 	timer_thread_active = timer_thread_init();
 #endif
 #endif
@@ -309,25 +565,76 @@ void TimerExit(void)
 #endif
 #ifdef PRECISE_TIMING_POSIX
 		timer_thread_kill();
+#endif
+#ifdef PRECISE_TIMING_TIMERFD
+		timer_thread_kill();
+		print_jitter("Time Manager", timer_jitter);
+		print_jitter("Tick", tick_jitter);
+		D(bug("%u ticks dropped\n", tick_overruns));
 #endif
 	}
 #endif
 }
 
 
+/*
+ *  Periodic function run by the timer thread
+ */
+
+#ifdef PRECISE_TIMING_TIMERFD
+bool TimerStartTick(bool (*func)(void), uint32 period_usec)
+{
+	if (!timer_thread_active)
+		return false;
+
+	// The deadlines are absolute, so the tick doesn't drift
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	pthread_mutex_lock(&tick_lock);
+	tick_func = func;
+	tick_period_ns = (uint64)period_usec * 1000;
+	tick_next_ns = timespec_to_ns(now) + tick_period_ns;
+	struct itimerspec its;
+	ns_to_timespec(its.it_value, tick_next_ns);
+	ns_to_timespec(its.it_interval, tick_period_ns);
+	bool ok = (timerfd_settime(tick_fd, TFD_TIMER_ABSTIME, &its, NULL) == 0);
+	if (!ok)
+		tick_func = NULL;
+	pthread_mutex_unlock(&tick_lock);
+	return ok;
+}
+
+void TimerStopTick(void)
+{
+	pthread_mutex_lock(&tick_lock);
+	struct itimerspec its;
+	memset(&its, 0, sizeof(its));
+	timerfd_settime(tick_fd, 0, &its, NULL);
+	tick_func = NULL;
+	pthread_mutex_unlock(&tick_lock);
+}
+#endif
+
+
 /*
  *  Emulator reset, remove all timer tasks
  */
 
 void TimerReset(void)
 {
-	TMDesc *desc = tmDescList;
-	while (desc) {
-		TMDesc *next = desc->next;
-		delete desc;
-		desc = next;
+	for (int i = 0; i < TMDESC_HASH_SIZE; i++) {
+		TMDesc *desc = tmDescHash[i];
+		while (desc) {
+			TMDesc *next = desc->next;
+			delete desc;
+			desc = next;
+		}
+		tmDescHash[i] = NULL;
 	}
-	tmDescList = NULL;
+	tmDescHeap.clear();
+#if PRECISE_TIMING
+	wakeup_time_set = wakeup_time_max;
+#endif
 }
 
 
@@ -344,8 +651,10 @@ int16 InsTime(uint32 tm, uint16 trap)
 	else {
 		TMDesc *desc = new TMDesc;
 		desc->task = tm;
-		desc->next = tmDescList;
-		tmDescList = desc;
+		desc->heap_index = -1;
+		TMDesc **slot = desc_hash_slot(tm);
+		desc->next = *slot;
+		*slot = desc;
 	}
 	return 0;
 }
@@ -367,31 +676,11 @@ int16 RmvTime(uint32 tm)
 	}
 
 	// Task active?
-#if PRECISE_TIMING_BEOS
-	while (acquire_sem(wakeup_time_sem) == B_INTERRUPTED) ;
-	suspend_thread(timer_thread);
-#endif
-#ifdef PRECISE_TIMING_MACH
-	semaphore_wait(wakeup_time_sem);
-	thread_suspend(timer_thread);
-#endif
-#if PRECISE_TIMING_POSIX
-	pthread_mutex_lock(&wakeup_time_lock);
-	timer_thread_suspend();
-#endif
 	if (ReadMacInt16(tm + qType) & 0x8000) {
 
 		// Yes, make task inactive and remove it from the Time Manager queue
 		WriteMacInt16(tm + qType, ReadMacInt16(tm + qType) & 0x7fff);
 		dequeue_tm(tm);
-#if PRECISE_TIMING
-		// Look for next task to be called and set wakeup_time
-		wakeup_time = wakeup_time_max;
-		for (TMDesc *d = tmDescList; d; d = d->next)
-			if ((ReadMacInt16(d->task + qType) & 0x8000))
-				if (timer_cmp_time(d->wakeup, wakeup_time) < 0)
-					wakeup_time = d->wakeup;
-#endif
 
 		// Compute remaining time
 		tm_time_t remaining, current;
@@ -401,26 +690,9 @@ int16 RmvTime(uint32 tm)
 	} else
 		WriteMacInt32(tm + tmCount, 0);
 	D(bug(" tmCount %d\n", ReadMacInt32(tm + tmCount)));
-#if PRECISE_TIMING_BEOS
-	release_sem(wakeup_time_sem);
-	thread_info info;
-	do {
-		resume_thread(timer_thread);			// This will unblock the thread
-		get_thread_info(timer_thread, &info);
-	} while (info.state == B_THREAD_SUSPENDED);	// Sometimes, resume_thread() doesn't work (BeOS bug?)
-#endif
-#ifdef PRECISE_TIMING_MACH
-	semaphore_signal(wakeup_time_sem);
-	thread_abort(timer_thread);
-	thread_resume(timer_thread);
-#endif
-#if PRECISE_TIMING_POSIX
-	pthread_mutex_unlock(&wakeup_time_lock);
-	timer_thread_resume();
-	assert(suspend_count == 0);
-#endif
 
-	// Free descriptor
+	// Free descriptor, which unschedules it. The next wakeup time can only
+	// get later, so the timer thread is left alone.
 	free_desc(desc);
 	return 0;
 }
@@ -484,45 +756,11 @@ int16 PrimeTime(uint32 tm, int32 time)
 	}
 
 	// Make task active and enqueue it in the Time Manager queue
-#if PRECISE_TIMING_BEOS
-	while (acquire_sem(wakeup_time_sem) == B_INTERRUPTED) ;
-	suspend_thread(timer_thread);
-#endif
-#ifdef PRECISE_TIMING_MACH
-	semaphore_wait(wakeup_time_sem);
-	thread_suspend(timer_thread);
-#endif
-#if PRECISE_TIMING_POSIX
-	pthread_mutex_lock(&wakeup_time_lock);
-	timer_thread_suspend();
-#endif
 	WriteMacInt16(tm + qType, ReadMacInt16(tm + qType) | 0x8000);
 	enqueue_tm(tm);
+	heap_schedule(desc);
 #if PRECISE_TIMING
-	// Look for next task to be called and set wakeup_time
-	wakeup_time = wakeup_time_max;
-	for (TMDesc *d = tmDescList; d; d = d->next)
-		if ((ReadMacInt16(d->task + qType) & 0x8000))
-			if (timer_cmp_time(d->wakeup, wakeup_time) < 0)
-				wakeup_time = d->wakeup;
-#ifdef PRECISE_TIMING_BEOS
-	release_sem(wakeup_time_sem);
-	thread_info info;
-	do {
-		resume_thread(timer_thread);			// This will unblock the thread
-		get_thread_info(timer_thread, &info);
-	} while (info.state == B_THREAD_SUSPENDED);	// Sometimes, resume_thread() doesn't work (BeOS bug?)
-#endif
-#ifdef PRECISE_TIMING_MACH
-	semaphore_signal(wakeup_time_sem);
-	thread_abort(timer_thread);
-	thread_resume(timer_thread);
-#endif
-#ifdef PRECISE_TIMING_POSIX
-	pthread_mutex_unlock(&wakeup_time_lock);
-	timer_thread_resume();
-	assert(suspend_count == 0);
-#endif
+	set_wakeup_time(false);
 #endif
 	return 0;
 }
@@ -578,6 +816,59 @@ static void *timer_func(void *arg)
 }
 #endif
 
+#ifdef PRECISE_TIMING_TIMERFD
+static void *timer_func(void *arg)
+{
+	for (;;) {
+		struct epoll_event events[2];
+		int n = epoll_wait(timer_epoll_fd, events, 2, -1);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		// Don't get cancelled while holding tick_lock
+		int cancel_state;
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+		for (int i = 0; i < n; i++) {
+			uint64 expirations;
+			if (events[i].data.fd == timer_fd) {
+
+				// Nothing to read if the timer was rearmed in the meantime
+				if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+					continue;
+				record_jitter(timer_jitter, __atomic_load_n(&wakeup_time_ns, __ATOMIC_RELAXED));
+
+				// Timer expired, trigger interrupt
+				SetInterruptFlag(INTFLAG_TIMER);
+				TriggerInterrupt();
+
+			} else {
+
+				// Periodic function, missed deadlines are dropped
+				pthread_mutex_lock(&tick_lock);
+				if (read(tick_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+					tick_overruns += expirations - 1;
+					tick_next_ns += (expirations - 1) * tick_period_ns;
+					record_jitter(tick_jitter, tick_next_ns);
+					tick_next_ns += tick_period_ns;
+					if (tick_func && !tick_func()) {
+						struct itimerspec its;
+						memset(&its, 0, sizeof(its));
+						timerfd_settime(tick_fd, 0, &its, NULL);
+						tick_func = NULL;
+					}
+				}
+				pthread_mutex_unlock(&tick_lock);
+			}
+		}
+		pthread_setcancelstate(cancel_state, NULL);
+	}
+	return NULL;
+}
+#endif
+
 #ifdef PRECISE_TIMING_POSIX
 static void *timer_func(void *arg)
 {
@@ -608,14 +899,24 @@ static void *timer_func(void *arg)
 
 void TimerInterrupt(void)
 {
-	// Look for active TMTasks that have expired
+	// Look for active TMTasks that have expired, take them off the heap
+	// first because the timer functions may install, prime or remove tasks
 	tm_time_t now;
 	timer_current_time(now);
-	TMDesc *desc = tmDescList;
-	while (desc) {
-		TMDesc *next = desc->next;
-		uint32 tm = desc->task;
-		if ((ReadMacInt16(tm + qType) & 0x8000) && timer_cmp_time(desc->wakeup, now) <= 0) {
+	tmExpired.clear();
+	while (!tmDescHeap.empty() && timer_cmp_time(tmDescHeap[0]->wakeup, now) <= 0) {
+		tmExpired.push_back(tmDescHeap[0]->task);
+		heap_unschedule(tmDescHeap[0]);
+	}
+	for (size_t i = 0; i < tmExpired.size(); i++) {
+		uint32 tm = tmExpired[i];
+
+		// Skip task if it was removed or primed again in the meantime
+		TMDesc *desc = find_desc(tm);
+		if (desc == NULL || desc->heap_index >= 0)
+			continue;
+
+		if (ReadMacInt16(tm + qType) & 0x8000) {
 
 			// Found one, mark as inactive and remove it from the Time Manager queue
 			WriteMacInt16(tm + qType, ReadMacInt16(tm + qType) & 0x7fff);
@@ -632,45 +933,10 @@ void TimerInterrupt(void)
 				D(bug(" returned from TimeTask\n"));
 			}
 		}
-		desc = next;
 	}
 
 #if PRECISE_TIMING
 	// Look for next task to be called and set wakeup_time
-#if PRECISE_TIMING_BEOS
-	while (acquire_sem(wakeup_time_sem) == B_INTERRUPTED) ;
-	suspend_thread(timer_thread);
-#endif
-#if PRECISE_TIMING_MACH
-	semaphore_wait(wakeup_time_sem);
-	thread_suspend(timer_thread);
-#endif
-#if PRECISE_TIMING_POSIX
-	pthread_mutex_lock(&wakeup_time_lock);
-	timer_thread_suspend();
-#endif
-	wakeup_time = wakeup_time_max;
-	for (TMDesc *d = tmDescList; d; d = d->next)
-		if ((ReadMacInt16(d->task + qType) & 0x8000))
-			if (timer_cmp_time(d->wakeup, wakeup_time) < 0)
-				wakeup_time = d->wakeup;
-#if PRECISE_TIMING_BEOS
-	release_sem(wakeup_time_sem);
-	thread_info info;
-	do {
-		resume_thread(timer_thread);			// This will unblock the thread
-		get_thread_info(timer_thread, &info);
-	} while (info.state == B_THREAD_SUSPENDED);	// Sometimes, resume_thread() doesn't work (BeOS bug?)
-#endif
-#if PRECISE_TIMING_MACH
-	semaphore_signal(wakeup_time_sem);
-	thread_abort(timer_thread);
-	thread_resume(timer_thread);
-#endif
-#if PRECISE_TIMING_POSIX
-	pthread_mutex_unlock(&wakeup_time_lock);
-	timer_thread_resume();
-	assert(suspend_count == 0);
-#endif
+	set_wakeup_time(true);
 #endif
 }
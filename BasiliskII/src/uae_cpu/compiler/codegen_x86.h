@@ -1607,6 +1607,13 @@ enum {
 #define BSWAPLr(R)			(_REXLrr(0, R),			_OOr		(0x0fc8,_r4(R)							))
 #define BSWAPQr(R)			(_REXQrr(0, R),			_OOr		(0x0fc8,_r8(R)							))
 
+#define MOVBEWmr(MD, MB, MI, MS, RD)	(_d16(), _REXLmr(MB, MI, RD),	_B(0x0f),_OO_r_X	(0x38f0		     ,_r2(RD)		,MD,MB,MI,MS		))
+#define MOVBEWrm(RS, MD, MB, MI, MS)	(_d16(), _REXLrm(RS, MB, MI),	_B(0x0f),_OO_r_X	(0x38f1		     ,_r2(RS)		,MD,MB,MI,MS		))
+#define MOVBELmr(MD, MB, MI, MS, RD)	(_REXLmr(MB, MI, RD),		_B(0x0f),_OO_r_X	(0x38f0		     ,_r4(RD)		,MD,MB,MI,MS		))
+#define MOVBELrm(RS, MD, MB, MI, MS)	(_REXLrm(RS, MB, MI),		_B(0x0f),_OO_r_X	(0x38f1		     ,_r4(RS)		,MD,MB,MI,MS		))
+#define MOVBEQmr(MD, MB, MI, MS, RD)	_m64only((_REXQmr(MB, MI, RD),	_B(0x0f),_OO_r_X	(0x38f0		     ,_r8(RD)		,MD,MB,MI,MS		)))
+#define MOVBEQrm(RS, MD, MB, MI, MS)	_m64only((_REXQrm(RS, MB, MI),	_B(0x0f),_OO_r_X	(0x38f1		     ,_r8(RS)		,MD,MB,MI,MS		)))
+
 #define CLC()								_O		(0xf8								)
 #define STC()								_O		(0xf9								)
 #define CMC()								_O		(0xf5								)
@@ -101,7 +101,7 @@ union cacheline {
 #endif
 
 /* Does flush_icache_range() only check for blocks falling in the requested range? */
-#define LAZY_FLUSH_ICACHE_RANGE 0
+#define LAZY_FLUSH_ICACHE_RANGE USE_CHECKSUM_INFO
 
 #define USE_F_ALIAS 1
 #define USE_OFFSET 1
@@ -180,6 +180,7 @@ extern int get_cache_state(void);
 extern uae_u32 get_jitted_size(void);
 #ifdef JIT
 extern void (*flush_icache)(void);
+extern void flush_icache_range(uae_u8 *start_p, uae_u32 length);
 #endif
 extern void alloc_cache(void);
 extern int check_for_cache_miss(void);
@@ -516,6 +517,7 @@ void do_nothing(void);
 #else
 
 static inline void flush_icache(void) { }
+static inline void flush_icache_range(uae_u8 *, uae_u32) { }
 
 #endif /* !USE_JIT */
 
@@ -217,6 +217,9 @@ void jit_abort(const char *format, ...)
 # include <cstdlib>
 # include <cerrno>
 # include <cassert>
+# include <map>
+# include <vector>
+# include <algorithm>
 
 #if defined(CPU_x86_64) && 0
 #define RECORD_REGISTER_USAGE		1
@@ -263,6 +266,146 @@ static int untranslated_compfn(const void *e1, const void *e2)
 }
 #endif
 
+#ifndef UAE
+// Per-block execution profile, enabled with the "jitprofile" prefs item
+struct block_profile {
+	uae_u32 pc;					// 68k address of block
+	uae_u32 length;				// Number of 68k instructions
+	uae_u32 fallbacks;			// Number of instructions run by the interpreter
+	uae_u32 compiles;			// Number of translations of this block
+	bool interpreted;			// Whole block is run by the interpreter (optlevel 0)
+	bool ends_in_fallback;		// Last instruction is run by the interpreter
+	uae_u64 count;				// Number of executions
+	uae_u64 cycles;				// Host cycles from entering this block to entering the next one
+};
+
+static bool jit_profile = false;
+static std::vector<block_profile> block_profiles;
+static std::map<uae_u32, uae_u32> block_profile_index;	// 68k address -> index in block_profiles
+static uae_u32 jit_profile_insn_count[65536];			// Executions of untranslated opcodes
+static uae_s32 jit_profile_last = -1;					// Index of block entered last
+static uae_u64 jit_profile_last_time;
+static volatile sig_atomic_t jit_profile_dump_requested = 0;
+static void jit_profile_report(void);
+
+static inline uae_u64 jit_profile_time(void)
+{
+#if defined(CPU_i386) || defined(CPU_x86_64)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uae_u64)t.tv_sec * 1000000000 + t.tv_nsec;
+#endif
+}
+
+// Called from compiled code on block entry
+static void jit_profile_enter(uae_u32 index)
+{
+	uae_u64 now = jit_profile_time();
+	if (jit_profile_last >= 0)
+		block_profiles[jit_profile_last].cycles += now - jit_profile_last_time;
+	block_profiles[index].count++;
+	jit_profile_last = index;
+	jit_profile_last_time = now;
+
+	if (jit_profile_dump_requested) {
+		jit_profile_dump_requested = 0;
+		jit_profile_report();
+	}
+}
+
+#ifdef SIGUSR2
+static void jit_profile_signal(int)
+{
+	jit_profile_dump_requested = 1;
+}
+#endif
+
+// Get profile record of block starting at 68k address pc
+static uae_u32 jit_profile_block(uae_u32 pc)
+{
+	std::map<uae_u32, uae_u32>::iterator it = block_profile_index.find(pc);
+	uae_u32 index;
+	if (it != block_profile_index.end())
+		index = it->second;
+	else {
+		index = block_profiles.size();
+		block_profile bp;
+		memset(&bp, 0, sizeof(bp));
+		bp.pc = pc;
+		block_profiles.push_back(bp);
+		block_profile_index[pc] = index;
+	}
+	block_profile *bp = &block_profiles[index];
+	bp->length = 0;
+	bp->fallbacks = 0;
+	bp->interpreted = false;
+	bp->ends_in_fallback = false;
+	bp->compiles++;
+	return index;
+}
+
+static const char *opcode_name(uae_u16 opcode)
+{
+	struct instr *dp = table68k + opcode;
+	struct mnemolookup *lookup;
+	for (lookup = lookuptab; lookup->mnemo != (instrmnem)dp->mnemo; lookup++)
+		;
+	return lookup->name;
+}
+
+static bool block_profile_compare(uae_u32 a, uae_u32 b)
+{
+	return block_profiles[a].cycles > block_profiles[b].cycles;
+}
+
+static bool insn_count_compare(uae_u16 a, uae_u16 b)
+{
+	return jit_profile_insn_count[a] > jit_profile_insn_count[b];
+}
+
+// Print hottest blocks and most frequently interpreted opcodes
+static void jit_profile_report(void)
+{
+	const int top_blocks = 50;
+	const int top_insns = 50;
+
+	std::vector<uae_u32> blocks;
+	uae_u64 total_cycles = 0;
+	for (uae_u32 i = 0; i < block_profiles.size(); i++) {
+		if (block_profiles[i].count) {
+			blocks.push_back(i);
+			total_cycles += block_profiles[i].cycles;
+		}
+	}
+	std::sort(blocks.begin(), blocks.end(), block_profile_compare);
+
+	printf("### JIT block profile: %d blocks compiled, %d executed\n", (int)block_profiles.size(), (int)blocks.size());
+	printf("Rank  Address        Count           Cycles      %%  Insns  Fallb  Comp  Flags\n");
+	for (int i = 0; i < top_blocks && i < (int)blocks.size(); i++) {
+		const block_profile &bp = block_profiles[blocks[i]];
+		printf("%03d:  %08x  %10llu  %15llu  %5.1f  %5u  %5u  %4u  %s%s\n",
+			i, bp.pc, (unsigned long long)bp.count, (unsigned long long)bp.cycles,
+			total_cycles ? 100.0 * double(bp.cycles) / double(total_cycles) : 0.0,
+			bp.length, bp.fallbacks, bp.compiles,
+			bp.interpreted ? "I" : "", bp.ends_in_fallback ? "F" : "");
+	}
+
+	std::vector<uae_u16> insns;
+	for (int i = 0; i < 65536; i++) {
+		if (jit_profile_insn_count[i])
+			insns.push_back(i);
+	}
+	std::sort(insns.begin(), insns.end(), insn_count_compare);
+
+	printf("### JIT untranslated instructions in compiled blocks\n");
+	printf("Rank  Opc      Count Name\n");
+	for (int i = 0; i < top_insns && i < (int)insns.size(); i++)
+		printf("%03d: %04x %10u %s\n", i, insns[i], jit_profile_insn_count[insns[i]], opcode_name(insns[i]));
+}
+#endif
+
 static compop_func *compfunctbl[65536];
 static compop_func *nfcompfunctbl[65536];
 #ifdef NOFLAGS_SUPPORT
@@ -2950,6 +3093,14 @@ void compiler_init(void)
 	jit_log("<JIT compiler> : block inlining : %s", str_on_off(follow_const_jumps));
 	jit_log("<JIT compiler> : separate blockinfo allocation : %s", str_on_off(USE_SEPARATE_BIA));
 
+	// Per-block execution profile
+	jit_profile = PrefsFindBool("jitprofile");
+	jit_log("<JIT compiler> : per-block execution profile : %s", str_on_off(jit_profile));
+#ifdef SIGUSR2
+	if (jit_profile)
+		signal(SIGUSR2, jit_profile_signal);
+#endif
+
 	// Build compiler tables
 	init_table68k ();
 	build_comp();
@@ -3016,17 +3167,17 @@ void compiler_exit(void)
 	jit_log("Rank  Opc      Count Name");
 	for (int i = 0; i < untranslated_top_ten; i++) {
 		uae_u32 count = raw_cputbl_count[opcode_nums[i]];
-		struct instr *dp;
-		struct mnemolookup *lookup;
 		if (!count)
 			break;
-		dp = table68k + opcode_nums[i];
-		for (lookup = lookuptab; lookup->mnemo != (instrmnem)dp->mnemo; lookup++)
-			;
-		bug("%03d: %04x %10u %s", i, opcode_nums[i], count, lookup->name);
+		bug("%03d: %04x %10u %s", i, opcode_nums[i], count, opcode_name(opcode_nums[i]));
 	}
 #endif
 
+#ifndef UAE
+	if (jit_profile)
+		jit_profile_report();
+#endif
+
 #ifdef RECORD_REGISTER_USAGE
 	int reg_count_ids[16];
 	uint64 tot_reg_count = 0;
@@ -4092,6 +4243,50 @@ static inline void create_popalls(void)
 	// flush_cpu_icache((void *)popallspace, (void *)target);
 }
 
+#if LAZY_FLUSH_ICACHE_RANGE
+/* Blocks indexed by the (host) pages their 68k code lives in, so that
+   flush_icache_range() only has to look at blocks near the flushed range.
+   Entries are hints: they are checked against the checksum_info chain of
+   the block, and dropped when the block has moved elsewhere or was freed. */
+#define PAGE_INDEX_SHIFT 12
+#define PAGE_INDEX_SIZE 4096
+static std::vector<blockinfo *> page_index[PAGE_INDEX_SIZE];
+
+static inline std::vector<blockinfo *> &page_index_slot(uintptr page)
+{
+	return page_index[page & (PAGE_INDEX_SIZE - 1)];
+}
+
+static bool block_overlaps_range(blockinfo *bi, uae_u8 *start_p, uae_u32 length)
+{
+	for (checksum_info *csi = bi->csi; csi; csi = csi->next) {
+		if ((uintptr)(start_p - csi->start_p) < csi->length ||
+			(uintptr)(csi->start_p - start_p) < length)
+			return true;
+	}
+	return false;
+}
+
+static void page_index_add(blockinfo *bi)
+{
+	for (checksum_info *csi = bi->csi; csi; csi = csi->next) {
+		uintptr first = (uintptr)csi->start_p >> PAGE_INDEX_SHIFT;
+		uintptr last = ((uintptr)csi->start_p + csi->length - 1) >> PAGE_INDEX_SHIFT;
+		for (uintptr page = first; page <= last; page++) {
+			std::vector<blockinfo *> &slot = page_index_slot(page);
+			if (std::find(slot.begin(), slot.end(), bi) == slot.end())
+				slot.push_back(bi);
+		}
+	}
+}
+
+static void page_index_reset(void)
+{
+	for (int i = 0; i < PAGE_INDEX_SIZE; i++)
+		page_index[i].clear();
+}
+#endif
+
 static inline void reset_lists(void)
 {
 	int i;
@@ -4100,6 +4295,9 @@ static inline void reset_lists(void)
 		hold_bi[i]=NULL;
 	active=NULL;
 	dormant=NULL;
+#if LAZY_FLUSH_ICACHE_RANGE
+	page_index_reset();
+#endif
 }
 
 static void prepare_block(blockinfo* bi)
@@ -4605,43 +4803,57 @@ static inline void flush_icache_lazy(void)
 }
 
 
-#if 0
-static void flush_icache_range(uae_u32 start, uae_u32 length)
+/* Flush the translations of the 68k code in [start_p, start_p + length[.
+   Only the blocks overlapping the range are marked for checking (or
+   invalidated if lazy flushing is disabled), the rest stays active. */
+void flush_icache_range(uae_u8 *start_p, uae_u32 length)
 {
 	if (!active)
 		return;
 
 #if LAZY_FLUSH_ICACHE_RANGE
-	uae_u8 *start_p = get_real_address(start);
-	blockinfo *bi = active;
-	while (bi) {
-#if USE_CHECKSUM_INFO
-		bool invalidate = false;
-		for (checksum_info *csi = bi->csi; csi && !invalidate; csi = csi->next)
-			invalidate = (((start_p - csi->start_p) < csi->length) ||
-						  ((csi->start_p - start_p) < length));
-#else
-		// Assume system is consistent and would invalidate the right range
-		const bool invalidate = (bi->pc_p - start_p) < length;
-#endif
-		if (invalidate) {
-			uae_u32 cl = cacheline(bi->pc_p);
-			if (bi == cache_tags[cl + 1].bi)
-					cache_tags[cl].handler = (cpuop_func *)popall_execute_normal;
-			bi->handler_to_use = (cpuop_func *)popall_execute_normal;
-			set_dhtu(bi, bi->direct_pen);
-			bi->status = BI_NEED_RECOMP;
+	if (start_p && length) {
+		uintptr first = (uintptr)start_p >> PAGE_INDEX_SHIFT;
+		uintptr last = ((uintptr)start_p + length - 1) >> PAGE_INDEX_SHIFT;
+		if (last - first < PAGE_INDEX_SIZE) {
+			for (uintptr page = first; page <= last; page++) {
+				uae_u8 *page_p = (uae_u8 *)(page << PAGE_INDEX_SHIFT);
+				std::vector<blockinfo *> &slot = page_index_slot(page);
+				for (size_t i = 0; i < slot.size(); ) {
+					blockinfo *bi = slot[i];
+					if (!block_overlaps_range(bi, page_p, 1 << PAGE_INDEX_SHIFT)) {
+						// Stale entry
+						slot[i] = slot.back();
+						slot.pop_back();
+						continue;
+					}
+					i++;
+					if (bi->status != BI_ACTIVE || !block_overlaps_range(bi, start_p, length))
+						continue;
+					if (lazy_flush) {
+						uae_u32 cl = cacheline(bi->pc_p);
+						if (bi == cache_tags[cl + 1].bi)
+							cache_tags[cl].handler = (cpuop_func *)popall_check_checksum;
+						bi->handler_to_use = (cpuop_func *)popall_check_checksum;
+						set_dhtu(bi, bi->direct_pcc);
+						bi->status = BI_NEED_CHECK;
+						remove_from_list(bi);
+						add_to_dormant(bi);
+					}
+					else {
+						invalidate_block(bi);
+						raise_in_cl_list(bi);
+					}
+				}
+			}
+			return;
 		}
-		bi = bi->next;
 	}
-	return;
-#else
-		UNUSED(start);
-		UNUSED(length);
+	else if (start_p)
+		return;
 #endif
 	flush_icache();
 }
-#endif
 
 
 int failure;
@@ -4898,6 +5110,25 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 			compemu_raw_sub_l_mi((uintptr)&(bi->count),1);
 			compemu_raw_jl((uintptr)popall_recompile_block);
 		}
+#ifndef UAE
+		block_profile *bp = NULL;
+		if (jit_profile) {
+			uae_u32 index = jit_profile_block((uae_u32)((uintptr)pc_hist[0].location - MEMBaseDiff));
+			bp = &block_profiles[index];
+			bp->length = blocklen;
+			bp->interpreted = (optlev == 0);
+			compemu_raw_mov_l_ri(REG_PAR1, index);
+#if USE_NORMAL_CALLING_CONVENTION
+			raw_push_l_r(REG_PAR1);
+#endif
+			raw_dec_sp(STACK_SHADOW_SPACE);
+			compemu_raw_call((uintptr)jit_profile_enter);
+			raw_inc_sp(STACK_SHADOW_SPACE);
+#if USE_NORMAL_CALLING_CONVENTION
+			raw_inc_sp(4);
+#endif
+		}
+#endif
 		if (optlev==0) { /* No need to actually translate */
 			/* Execute normally without keeping stats */
 			compemu_raw_mov_l_mi((uintptr)&regs.pc_p,(uintptr)pc_hist[0].location);
@@ -5077,6 +5308,13 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 					// raw_cputbl_count[] is indexed with plain opcode (in m68k order)
 					compemu_raw_add_l_mi((uintptr)&raw_cputbl_count[cft_map(opcode)],1);
 #endif
+#ifndef UAE
+					if (bp) {
+						bp->fallbacks++;
+						bp->ends_in_fallback = (i == blocklen - 1);
+						compemu_raw_add_l_mi((uintptr)&jit_profile_insn_count[cft_map(opcode)],1);
+					}
+#endif
 #if USE_NORMAL_CALLING_CONVENTION
 					raw_inc_sp(4);
 #endif
@@ -5348,6 +5586,10 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 		bi->nexthandler=current_compile_p;
 #endif
 
+#if LAZY_FLUSH_ICACHE_RANGE
+		page_index_add(bi);
+#endif
+
 		/* We will flush soon, anyway, so let's do it now */
 		if (current_compile_p >= MAX_COMPILE_PTR)
 			flush_icache_hard();
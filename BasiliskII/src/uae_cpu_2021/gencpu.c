@@ -2340,14 +2340,14 @@ static void gen_opcode (unsigned long int opcode)
 	printf ("\tflush_internals();\n");
         printf("#ifdef USE_JIT\n");
  	printf ("\tif (opcode&0x80)\n"
-		"\t\tflush_icache();\n");
+		"\t\tflush_icache_range(get_real_address(m68k_areg(regs, dstreg) & ~15), 16);\n");
 	printf("#endif\n");
 	break;
      case i_CINVP:
 	printf ("\tflush_internals();\n");
         printf("#ifdef USE_JIT\n");
 	printf ("\tif (opcode&0x80)\n"
-		"\t\tflush_icache();\n");
+		"\t\tflush_icache_range(get_real_address(m68k_areg(regs, dstreg) & ~4095), 4096);\n");
 	printf("#endif\n");
 	break;
      case i_CINVA:
@@ -2361,14 +2361,14 @@ static void gen_opcode (unsigned long int opcode)
 	printf ("\tflush_internals();\n");
         printf("#ifdef USE_JIT\n");
 	printf ("\tif (opcode&0x80)\n"
-		"\t\tflush_icache();\n");
+		"\t\tflush_icache_range(get_real_address(m68k_areg(regs, dstreg) & ~15), 16);\n");
 	printf("#endif\n");
 	break;
      case i_CPUSHP:
 	printf ("\tflush_internals();\n");
         printf("#ifdef USE_JIT\n");
 	printf ("\tif (opcode&0x80)\n"
-		"\t\tflush_icache();\n");
+		"\t\tflush_icache_range(get_real_address(m68k_areg(regs, dstreg) & ~4095), 4096);\n");
 	printf("#endif\n");
 	break;
      case i_CPUSHA:
@@ -61,6 +61,17 @@ extern bool UseJIT;
 
 #define SANITY_CHECK_ATC 1
 
+/* Interpret straight-line code from predecoded instruction blocks */
+#ifndef M68K_DECODE_CACHE
+#if !defined(FULLMMU) && !defined(ARAM_PAGE_CHECK) && !defined(FULL_HISTORY) && !defined(FLIGHT_RECORDER)
+#define M68K_DECODE_CACHE 1
+#endif
+#endif
+
+#if M68K_DECODE_CACHE
+static void init_decode_cache(void);
+#endif
+
 struct fixup fixup = {0, 0, 0};
 
 int quit_program = 0;
@@ -231,6 +242,9 @@ void init_m68k (void)
 	movem_next[i] = i & (~(1 << j));
     }
     fpu_init (CPUType == 4);
+#if M68K_DECODE_CACHE
+    init_decode_cache();
+#endif
 }
 
 void exit_m68k (void)
@@ -1502,8 +1516,144 @@ int m68k_do_specialties(void)
 	return 0;
 }
 
+#if M68K_DECODE_CACHE
+/*
+ *  Predecoded instruction blocks. A straight-line run of instructions is
+ *  recorded while it is interpreted the normal way, and then replayed from
+ *  the array of handlers with a single ticks and spcflags check per block.
+ *  Every replayed instruction must still be reached (the previous one did
+ *  not trap or branch elsewhere) and still have the recorded opcode, so
+ *  the blocks need no invalidation on code changes.
+ */
+
+const int DECODE_CACHE_SIZE = 4096;		// Number of blocks (must be a power of 2)
+const int DECODE_BLOCK_LENGTH = 16;		// Maximum number of instructions per block
+
+struct decode_insn {
+	cpuop_func *handler;
+	uae_u8 *location;			// Host address of instruction
+	uaecptr pc;					// 68k address of instruction
+	uae_u32 opcode;				// Opcode as returned by GET_OPCODE
+};
+
+struct decode_block {
+	uae_u8 *start;				// Host address of first instruction, NULL if free
+	int length;
+	decode_insn insns[DECODE_BLOCK_LENGTH];
+};
+
+static decode_block decode_cache[DECODE_CACHE_SIZE];
+
+// Bitmap of opcodes (as returned by GET_OPCODE) that end a block
+static uae_u8 decode_end_block_tbl[65536 / 8];
+
+static void init_decode_cache(void)
+{
+	// The opcode table may not be built (it is only needed by the JIT)
+	bool own_table = (table68k == NULL);
+	if (own_table)
+		init_table68k();
+
+	memset(decode_end_block_tbl, 0, sizeof(decode_end_block_tbl));
+	for (int opcode = 0; opcode < 65536; opcode++) {
+		const struct instr *dp = &table68k[opcode];
+		// Branches, instructions that can trap or change SR, unknown opcodes
+		if (dp->mnemo == i_ILLG || (dp->cflow & (fl_end_block | fl_trap))) {
+#ifdef HAVE_GET_WORD_UNSWAPPED
+			uae_u32 i = do_byteswap_16(opcode);
+#else
+			uae_u32 i = opcode;
+#endif
+			decode_end_block_tbl[i >> 3] |= 1 << (i & 7);
+		}
+	}
+
+	if (own_table)
+		exit_table68k();
+}
+
+static inline decode_block *decode_cache_block(uae_u8 *start)
+{
+	return &decode_cache[((uintptr)start >> 1) & (DECODE_CACHE_SIZE - 1)];
+}
+
+static inline bool decode_end_block(uae_u32 opcode)
+{
+	return decode_end_block_tbl[opcode >> 3] & (1 << (opcode & 7));
+}
+
+// Interpret one block the normal way and record it
+static void __attribute__((noinline)) m68k_record_block(void)
+{
+	uae_u8 *start = regs.pc_p;
+	decode_block *b = decode_cache_block(start);
+	b->start = NULL;
+
+	int n = 0;
+	for (;;) {
+		uaecptr pc = m68k_getpc();
+		regs.fault_pc = pc;
+		uae_u32 opcode = GET_OPCODE;
+		decode_insn *e = &b->insns[n++];
+		e->handler = cpufunctbl[opcode];
+		e->location = regs.pc_p;
+		e->pc = pc;
+		e->opcode = opcode;
+		(*e->handler)(opcode);
+		cpu_check_ticks();
+		if (n == DECODE_BLOCK_LENGTH || decode_end_block(opcode) || SPCFLAGS_TEST(SPCFLAG_ALL))
+			break;
+	}
+
+	// Blocks recorded while tracing stop after every instruction, don't keep them
+	if (!(regs.t0 || regs.t1)) {
+		b->start = start;
+		b->length = n;
+	}
+}
+
+// Execute recorded block, return false if there is none for the current PC
+static inline bool m68k_execute_block(void)
+{
+	decode_block *b = decode_cache_block(regs.pc_p);
+	if (b->start != regs.pc_p)
+		return false;
+
+	const decode_insn *e = b->insns, *end = e + b->length;
+	do {
+		regs.fault_pc = e->pc;
+#ifdef HAVE_GET_WORD_UNSWAPPED
+		uae_u32 opcode = do_get_mem_word_unswapped((uae_u16 *)e->location);
+#else
+		uae_u32 opcode = do_get_mem_word((uae_u16 *)e->location);
+#endif
+		if (opcode != e->opcode) {
+			// Code was modified, record again next time
+			b->start = NULL;
+			break;
+		}
+		(*e->handler)(opcode);
+		e++;
+	} while (e < end && regs.pc_p == e->location);
+	cpu_check_ticks(e - b->insns);
+	return true;
+}
+#endif
+
 void m68k_do_execute (void)
 {
+#if M68K_DECODE_CACHE
+    for (;;) {
+	if (regs.t0 || regs.t1 || !m68k_execute_block())
+	    m68k_record_block();
+	regs.fault_pc = m68k_getpc();
+
+	if (SPCFLAGS_TEST(SPCFLAG_ALL_BUT_EXEC_RETURN)) {
+		if (m68k_do_specialties())
+			return;
+	}
+    }
+#else
     uae_u32 pc;
     uae_u32 opcode;
     for (;;) {
@@ -1545,6 +1695,7 @@ void m68k_do_execute (void)
 			return;
 	}
     }
+#endif
 }
 
 void m68k_execute (void)
@@ -325,6 +325,12 @@ static inline void cpu_check_ticks(void)
 	if (--emulated_ticks <= 0)
 		cpu_do_check_ticks();
 }
+
+static inline void cpu_check_ticks(int n)
+{
+	if ((emulated_ticks -= n) <= 0)
+		cpu_do_check_ticks();
+}
 #else
 extern uint16 emulated_ticks;
 static inline void cpu_check_ticks(void)
@@ -332,6 +338,14 @@ static inline void cpu_check_ticks(void)
 	if (!++emulated_ticks)
 		cpu_do_check_ticks();
 }
+
+static inline void cpu_check_ticks(int n)
+{
+	uint16 old_ticks = emulated_ticks;
+	emulated_ticks += n;
+	if (emulated_ticks < old_ticks)
+		cpu_do_check_ticks();
+}
 #endif
 
 cpuop_func op_illg_1;
@@ -0,0 +1 @@
+../../../BasiliskII/src/CrossPlatform/video_tiles.h
\ No newline at end of file
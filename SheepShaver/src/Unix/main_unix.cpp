@@ -240,6 +240,9 @@ static pthread_t nvram_thread;				// NVRAM watchdog
 static bool tick_thread_active = false;		// Flag: MacOS thread installed
 static volatile bool tick_thread_cancel;	// Flag: Cancel 60Hz thread
 static pthread_t tick_thread;				// 60Hz thread
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_active = false;		// Flag: 60Hz tick run by timer thread
+#endif
 static pthread_t emul_thread;				// MacOS thread
 static int use_gui = -1;   					// Override prefs and show gui
 
@@ -277,6 +280,9 @@ static void Quit(void);
 static void *emul_func(void *arg);
 static void *nvram_func(void *arg);
 static void *tick_func(void *arg);
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_func(void);
+#endif
 #if EMULATED_PPC
 extern void emul_ppc(uint32 start);
 extern void init_emul_ppc(void);
@@ -1160,10 +1166,17 @@ int main(int argc, char **argv)
 #endif
 	vm_protect(ROMBaseHost, ROM_AREA_SIZE, VM_PAGE_READ | VM_PAGE_EXECUTE);
 
-	// Start 60Hz thread
-	tick_thread_cancel = false;
-	tick_thread_active = (pthread_create(&tick_thread, NULL, tick_func, NULL) == 0);
-	D(bug("Tick thread installed (%ld)\n", tick_thread));
+#ifdef PRECISE_TIMING_TIMERFD
+	// Let the timer thread drive the 60Hz tick if possible
+	tick_timer_active = TimerStartTick(tick_timer_func, 16625);
+	if (!tick_timer_active)
+#endif
+	{
+		// Start 60Hz thread
+		tick_thread_cancel = false;
+		tick_thread_active = (pthread_create(&tick_thread, NULL, tick_func, NULL) == 0);
+		D(bug("Tick thread installed (%ld)\n", tick_thread));
+	}
 
 	// Start NVRAM watchdog thread
 	memcpy(last_xpram, XPRAM, XPRAM_SIZE);
@@ -1224,6 +1237,12 @@ static void Quit(void)
 	exit_emul_ppc();
 #endif
 
+#ifdef PRECISE_TIMING_TIMERFD
+	// Stop 60Hz tick
+	if (tick_timer_active)
+		TimerStopTick();
+#endif
+
 	// Stop 60Hz thread
 	if (tick_thread_active) {
 		tick_thread_cancel = true;
@@ -1509,10 +1528,69 @@ static void *nvram_func(void *arg)
  *  60Hz thread (really 60.15Hz)
  */
 
+// Perform one 60Hz tick, returns false if the emulator crashed
+static bool one_tick(void)
+{
+#if !EMULATED_PPC
+	// Did we crash?
+	if (emul_thread_fatal) {
+
+		// Yes, dump registers
+		sigregs *r = &sigsegv_regs;
+		if (crash_reason == NULL)
+			crash_reason = "SIGSEGV";
+		printf("%s\n"
+			"   pc %08lx     lr %08lx    ctr %08lx    msr %08lx\n"
+			"  xer %08lx     cr %08lx  \n"
+			"   r0 %08lx     r1 %08lx     r2 %08lx     r3 %08lx\n"
+			"   r4 %08lx     r5 %08lx     r6 %08lx     r7 %08lx\n"
+			"   r8 %08lx     r9 %08lx    r10 %08lx    r11 %08lx\n"
+			"  r12 %08lx    r13 %08lx    r14 %08lx    r15 %08lx\n"
+			"  r16 %08lx    r17 %08lx    r18 %08lx    r19 %08lx\n"
+			"  r20 %08lx    r21 %08lx    r22 %08lx    r23 %08lx\n"
+			"  r24 %08lx    r25 %08lx    r26 %08lx    r27 %08lx\n"
+			"  r28 %08lx    r29 %08lx    r30 %08lx    r31 %08lx\n",
+			crash_reason,
+			r->nip, r->link, r->ctr, r->msr,
+			r->xer, r->ccr,
+			r->gpr[0], r->gpr[1], r->gpr[2], r->gpr[3],
+			r->gpr[4], r->gpr[5], r->gpr[6], r->gpr[7],
+			r->gpr[8], r->gpr[9], r->gpr[10], r->gpr[11],
+			r->gpr[12], r->gpr[13], r->gpr[14], r->gpr[15],
+			r->gpr[16], r->gpr[17], r->gpr[18], r->gpr[19],
+			r->gpr[20], r->gpr[21], r->gpr[22], r->gpr[23],
+			r->gpr[24], r->gpr[25], r->gpr[26], r->gpr[27],
+			r->gpr[28], r->gpr[29], r->gpr[30], r->gpr[31]);
+		VideoQuitFullScreen();
+
+#ifdef ENABLE_MON
+		// Start up mon in real-mode
+		printf("Welcome to the sheep factory.\n");
+		const char *arg[4] = {"mon", "-m", "-r", NULL};
+		mon(3, arg);
+#endif
+		return false;
+	}
+#endif
+
+	// Pseudo Mac 1Hz interrupt, update local time
+	static int tick_counter = 0;
+	if (++tick_counter > 60) {
+		tick_counter = 0;
+		WriteMacInt32(0x20c, TimerDateTime());
+	}
+
+	// Trigger 60Hz interrupt
+	if (ReadMacInt32(XLM_IRQ_NEST) == 0) {
+		SetInterruptFlag(INTFLAG_VIA);
+		TriggerInterrupt();
+	}
+	return true;
+}
+
 bool tick_inhibit;
 static void *tick_func(void *arg)
 {
-	int tick_counter = 0;
 	uint64 start = GetTicks_usec();
 	int64 ticks = 0;
 	uint64 next = start;
@@ -1529,59 +1607,8 @@ static void *tick_func(void *arg)
 		if (tick_inhibit) continue;
 		ticks++;
 
-#if !EMULATED_PPC
-		// Did we crash?
-		if (emul_thread_fatal) {
-
-			// Yes, dump registers
-			sigregs *r = &sigsegv_regs;
-			if (crash_reason == NULL)
-				crash_reason = "SIGSEGV";
-			printf("%s\n"
-				"   pc %08lx     lr %08lx    ctr %08lx    msr %08lx\n"
-				"  xer %08lx     cr %08lx  \n"
-				"   r0 %08lx     r1 %08lx     r2 %08lx     r3 %08lx\n"
-				"   r4 %08lx     r5 %08lx     r6 %08lx     r7 %08lx\n"
-				"   r8 %08lx     r9 %08lx    r10 %08lx    r11 %08lx\n"
-				"  r12 %08lx    r13 %08lx    r14 %08lx    r15 %08lx\n"
-				"  r16 %08lx    r17 %08lx    r18 %08lx    r19 %08lx\n"
-				"  r20 %08lx    r21 %08lx    r22 %08lx    r23 %08lx\n"
-				"  r24 %08lx    r25 %08lx    r26 %08lx    r27 %08lx\n"
-				"  r28 %08lx    r29 %08lx    r30 %08lx    r31 %08lx\n",
-				crash_reason,
-				r->nip, r->link, r->ctr, r->msr,
-				r->xer, r->ccr,
-				r->gpr[0], r->gpr[1], r->gpr[2], r->gpr[3],
-				r->gpr[4], r->gpr[5], r->gpr[6], r->gpr[7],
-				r->gpr[8], r->gpr[9], r->gpr[10], r->gpr[11],
-				r->gpr[12], r->gpr[13], r->gpr[14], r->gpr[15],
-				r->gpr[16], r->gpr[17], r->gpr[18], r->gpr[19],
-				r->gpr[20], r->gpr[21], r->gpr[22], r->gpr[23],
-				r->gpr[24], r->gpr[25], r->gpr[26], r->gpr[27],
-				r->gpr[28], r->gpr[29], r->gpr[30], r->gpr[31]);
-			VideoQuitFullScreen();
-
-#ifdef ENABLE_MON
-			// Start up mon in real-mode
-			printf("Welcome to the sheep factory.\n");
-			const char *arg[4] = {"mon", "-m", "-r", NULL};
-			mon(3, arg);
-#endif
+		if (!one_tick())
 			return NULL;
-		}
-#endif
-
-		// Pseudo Mac 1Hz interrupt, update local time
-		if (++tick_counter > 60) {
-			tick_counter = 0;
-			WriteMacInt32(0x20c, TimerDateTime());
-		}
-
-		// Trigger 60Hz interrupt
-		if (ReadMacInt32(XLM_IRQ_NEST) == 0) {
-			SetInterruptFlag(INTFLAG_VIA);
-			TriggerInterrupt();
-		}
 	}
 
 	D(uint64 end = GetTicks_usec());
@@ -1589,6 +1616,15 @@ static void *tick_func(void *arg)
 	return NULL;
 }
 
+#ifdef PRECISE_TIMING_TIMERFD
+static bool tick_timer_func(void)
+{
+	if (tick_inhibit)
+		return true;
+	return one_tick();
+}
+#endif
+
 
 /*
  *  Pthread configuration
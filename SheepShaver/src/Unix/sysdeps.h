@@ -427,7 +427,10 @@ typedef struct timeval tm_time_t;
 #define C4X_FLOAT_FORMAT 4
 
 // High-precision timing
-#if defined(HAVE_PTHREADS) && defined(HAVE_CLOCK_NANOSLEEP)
+#if defined(HAVE_PTHREADS) && defined(HAVE_SYS_TIMERFD_H) && defined(HAVE_SYS_EPOLL_H)
+#define PRECISE_TIMING 1
+#define PRECISE_TIMING_TIMERFD 1
+#elif defined(HAVE_PTHREADS) && defined(HAVE_CLOCK_NANOSLEEP)
 #define PRECISE_TIMING 1
 #define PRECISE_TIMING_POSIX 1
 #elif defined(HAVE_PTHREADS) && defined(__MACH__)
@@ -334,6 +334,11 @@ void EmulOp(M68kRegisters *r, uint32 pc, int selector)
 					ClearInterruptFlag(INTFLAG_SERIAL);
 					SerialInterrupt();
 				}
+				if (InterruptFlags & INTFLAG_DISK) {
+					ClearInterruptFlag(INTFLAG_DISK);
+					SonyIOInterrupt();
+					DiskIOInterrupt();
+				}
 				if (InterruptFlags & INTFLAG_ETHER) {
 					ClearInterruptFlag(INTFLAG_ETHER);
 					ExecuteNative(NATIVE_ETHER_IRQ);
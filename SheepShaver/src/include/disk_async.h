@@ -0,0 +1 @@
+../../../BasiliskII/src/include/disk_async.h
\ No newline at end of file
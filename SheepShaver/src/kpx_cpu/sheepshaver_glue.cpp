@@ -185,6 +185,12 @@ sheepshaver_cpu::sheepshaver_cpu()
 {
 	init_decoder();
 
+#if PPC_DECODE_CACHE
+	int32 decode_cache_size = PrefsFindInt32("decodecachesize");
+	if (decode_cache_size > 0)
+		set_decode_cache_size(decode_cache_size * 1024);
+#endif
+
 #if PPC_ENABLE_JIT
 	if (PrefsFindBool("jit"))
 		enable_jit();
@@ -60,6 +60,10 @@ public:
 	void initialize();
 	void clear();
 	void clear_range(uintptr start, uintptr end);
+	template< class Predicate >
+	void clear_if(Predicate pred);
+	template< class Function >
+	void for_each(Function func);
 	block_info *fast_find(uintptr pc);
 	block_info *find(uintptr pc);
 
@@ -155,6 +159,36 @@ void block_cache< block_info, block_allocator >::clear_range(uintptr start, uint
 	}
 }
 
+template< class block_info, template<class T> class block_allocator >
+template< class Predicate >
+void block_cache< block_info, block_allocator >::clear_if(Predicate pred)
+{
+	entry *p, *q;
+	for (int i = 0; i < 2; i++) {
+		p = (i == 0) ? active : dormant;
+		while (p) {
+			q = p;
+			p = p->next;
+			if (pred(q)) {
+				q->invalidate();
+				remove_from_cl_list(q);
+				remove_from_list(q);
+				delete_blockinfo(q);
+			}
+		}
+	}
+}
+
+template< class block_info, template<class T> class block_allocator >
+template< class Function >
+void block_cache< block_info, block_allocator >::for_each(Function func)
+{
+	for (entry *p = active; p; p = p->next)
+		func(p);
+	for (entry *p = dormant; p; p = p->next)
+		func(p);
+}
+
 template< class block_info, template<class T> class block_allocator >
 inline block_info *block_cache< block_info, block_allocator >::new_blockinfo()
 {
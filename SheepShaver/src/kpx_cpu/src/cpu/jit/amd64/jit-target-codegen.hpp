@@ -55,6 +55,10 @@ public:
 		{ GEN_CODE(POPQm(mem.MD, mem.MB, mem.MI, mem.MS)); }
 	void gen_bswap_64(int r)
 		{ GEN_CODE(BSWAPQr(r)); }
+	void gen_movbe_64(x86_memory_operand const & mem, int d)
+		{ GEN_CODE(MOVBEQmr(mem.MD, mem.MB, mem.MI, mem.MS, d)); }
+	void gen_movbe_64(int s, x86_memory_operand const & mem)
+		{ GEN_CODE(MOVBEQrm(s, mem.MD, mem.MB, mem.MI, mem.MS)); }
 	void gen_lea_64(x86_memory_operand const & mem, int d)
 		{ GEN_CODE(LEAQmr(mem.MD, mem.MB, mem.MI, mem.MS, d)); }
 
@@ -83,7 +83,7 @@ basic_jit_cache::init_translation_cache(uint32 size)
 	D(bug("basic_jit_cache: Translation cache: %d KB at %p\n", cache_size / 1024, tcode_start));
 	code_start = tcode_start;
 	code_p = code_start;
-	code_end = code_p + size;
+	code_end = cache_end();
 	return true;
 }
 
@@ -114,6 +114,54 @@ basic_jit_cache::set_cache_size(uint32 size)
 		init_translation_cache(size);
 }
 
+uint8 *
+basic_jit_cache::cache_end() const
+{
+	return tcode_start + cache_size - JIT_CACHE_SIZE_GUARD;
+}
+
+void
+basic_jit_cache::invalidate_cache()
+{
+	code_p = code_start;
+	code_end = cache_end();
+}
+
+bool
+basic_jit_cache::reclaim_region(uint8 **start, uint8 **end)
+{
+	// The oldest region still in use follows the limit of free space
+	uint8 * const cache_end_p = cache_end();
+	uint8 *reclaim_p = code_end < cache_end_p ? code_end + JIT_CACHE_SIZE_GUARD : cache_end_p;
+
+	bool wrapped = false;
+	if (reclaim_p >= cache_end_p) {
+		// End of translation cache reached, wrap around
+		reclaim_p = code_start;
+		code_p = code_start;
+		wrapped = true;
+	}
+
+	// Regions must be large enough to absorb the overflow of one block
+	uint32 region_size = (cache_end_p - code_start) / CACHE_REGIONS;
+	if (region_size < 4 * JIT_CACHE_SIZE_GUARD)
+		region_size = 4 * JIT_CACHE_SIZE_GUARD;
+
+	// The last region extends to the end of the cache, its guard area
+	// follows it. Other regions stop early enough not to overflow into
+	// the next one, which is still in use
+	*start = reclaim_p;
+	*end = reclaim_p + region_size;
+	if (*end + region_size > cache_end_p) {
+		*end = cache_end_p;
+		code_end = cache_end_p;
+	}
+	else
+		code_end = *end - JIT_CACHE_SIZE_GUARD;
+	D(bug("basic_jit_cache: Reclaim region [%p - %p]%s\n", *start, *end, wrapped ? ", wrapped" : ""));
+	return wrapped;
+}
+
 uint8 *
 basic_jit_cache::copy_data(const uint8 *block, uint32 size)
 {
@@ -37,6 +37,12 @@ class basic_jit_cache
 	uint8 *code_p;
 	uint8 *code_end;
 
+	// Translation cache is reclaimed one region at a time, oldest first.
+	// CODE_END is then the limit of free space, one guard size short of
+	// the oldest region still in use
+	static const int CACHE_REGIONS = 8;
+	uint8 *cache_end() const;
+
 	// Data pool (32-bit addressable)
 	struct data_chunk_t {
 		uint32 size;
@@ -74,6 +80,15 @@ public:
 	bool full_translation_cache() const
 		{ return code_p >= code_end; }
 
+	// Reclaim the oldest region of the translation cache, returns TRUE
+	// if the cache wrapped around and code generation restarted from
+	// its beginning
+	bool reclaim_region(uint8 **start, uint8 **end);
+
+	// Resume code generation past the code that ends at PTR
+	void skip_code(uint8 *ptr)
+		{ if (ptr > code_p) code_p = ptr; }
+
 	// Emit code to translation cache
 	template< typename T >
 	void emit_generic(T v);
@@ -96,12 +111,6 @@ basic_jit_cache::set_code_start(uint8 *ptr)
 	code_start = ptr;
 }
 
-inline void
-basic_jit_cache::invalidate_cache()
-{
-	code_p = code_start;
-}
-
 template< class T >
 inline void
 basic_jit_cache::emit_generic(T v)
@@ -398,6 +398,14 @@ public:
 
 	void gen_bswap_32(int r)
 		{ GEN_CODE(BSWAPLr(r)); }
+	void gen_movbe_16(x86_memory_operand const & mem, int d)
+		{ GEN_CODE(MOVBEWmr(mem.MD, mem.MB, mem.MI, mem.MS, d)); }
+	void gen_movbe_16(int s, x86_memory_operand const & mem)
+		{ GEN_CODE(MOVBEWrm(s, mem.MD, mem.MB, mem.MI, mem.MS)); }
+	void gen_movbe_32(x86_memory_operand const & mem, int d)
+		{ GEN_CODE(MOVBELmr(mem.MD, mem.MB, mem.MI, mem.MS, d)); }
+	void gen_movbe_32(int s, x86_memory_operand const & mem)
+		{ GEN_CODE(MOVBELrm(s, mem.MD, mem.MB, mem.MI, mem.MS)); }
 	void gen_lea_32(x86_memory_operand const & mem, int d)
 		{ GEN_CODE(LEALmr(mem.MD, mem.MB, mem.MI, mem.MS, d)); }
 	void gen_clc(void)
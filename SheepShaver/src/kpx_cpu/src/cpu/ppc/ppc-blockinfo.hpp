@@ -52,6 +52,9 @@ struct powerpc_block_info
 	static const uint32	INVALID_PC = 0xffffffff;		// An invalid PC address to mark jmp_pc[] as stale
 	link_info			li[MAX_TARGETS];
 #endif
+#if PPC_ENABLE_SUPERBLOCKS
+	bool				superblock;						// Set if retranslated as a superblock
+#endif
 #endif
 	uintptr				min_pc, max_pc;
 
@@ -72,6 +75,10 @@ powerpc_block_info::init(uintptr start_pc)
 	for (int i = 0; i < MAX_TARGETS; i++)
 		li[i].jmp_pc = INVALID_PC;
 #endif
+#if PPC_ENABLE_SUPERBLOCKS
+	count = 0;
+	superblock = false;
+#endif
 #endif
 }
 
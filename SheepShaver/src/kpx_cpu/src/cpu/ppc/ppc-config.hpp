@@ -74,6 +74,19 @@
 #endif
 
 
+/**
+ *	PPC_ENABLE_SUPERBLOCKS
+ *
+ *		Define to 1 to retranslate hot loop headers into superblocks
+ *		that go on past forward conditional branches, with side exits.
+ *		This requires direct block chaining.
+ **/
+
+#ifndef PPC_ENABLE_SUPERBLOCKS
+#define PPC_ENABLE_SUPERBLOCKS 0
+#endif
+
+
 /**
  *	PPC_REENTRANT_JIT
  *
@@ -118,7 +131,8 @@
  *
  *		Define to enable some compile time statistics. This concerns
  *		time spent into the decoder (PPC_DECODE_CACHE case) or total
- *		time spent into the dynamic translator (PPC_ENABLE_JIT case).
+ *		time spent into the dynamic translator (PPC_ENABLE_JIT case),
+ *		including the number of CR updates lazy evaluation eliminated.
  **/
 
 #ifndef PPC_PROFILE_COMPILE_TIME
@@ -267,6 +267,9 @@ void powerpc_cpu::initialize()
 	init_flight_recorder();
 	init_decoder();
 	init_registers();
+#if PPC_DECODE_CACHE
+	decode_cache_entries = DECODE_CACHE_MAX_ENTRIES;
+#endif
 	init_decode_cache();
 	execute_depth = 0;
 
@@ -274,6 +277,9 @@ void powerpc_cpu::initialize()
 #if PPC_DECODE_CACHE || PPC_ENABLE_JIT
 	my_block_cache.initialize();
 #endif
+#if PPC_ENABLE_JIT && DYNGEN_DIRECT_BLOCK_CHAINING
+	chain_source_block = NULL;
+#endif
 
 	// Init cache range invalidate recorder
 	cache_range.start = cache_range.end = 0;
@@ -304,6 +310,16 @@ void powerpc_cpu::initialize()
 #if PPC_PROFILE_COMPILE_TIME
 	compile_count = 0;
 	compile_time = 0;
+#if PPC_ENABLE_JIT
+	cache_flush_count = 0;
+	cache_reclaim_count = 0;
+	cr_update_count = 0;
+	cr_eliminated_count = 0;
+#if PPC_ENABLE_SUPERBLOCKS
+	superblock_count = 0;
+	side_exit_count = 0;
+#endif
+#endif
 	emul_start_time = clock();
 #endif
 }
@@ -401,6 +417,18 @@ powerpc_cpu::~powerpc_cpu()
 		printf("Total %s time : %.1f sec (%.1f%%)\n", type,
 			   double(compile_time) / double(CLOCKS_PER_SEC),
 			   100.0 * double(compile_time) / double(emul_time));
+#if PPC_ENABLE_JIT
+		if (use_jit) {
+			printf("Total cache flush count : %d (%d regions reclaimed)\n",
+				   cache_flush_count, cache_reclaim_count);
+			printf("Total CR update count : %d (%d eliminated)\n",
+				   cr_update_count, cr_eliminated_count);
+#if PPC_ENABLE_SUPERBLOCKS
+			printf("Total superblock count : %d (%d side exits)\n",
+				   superblock_count, side_exit_count);
+#endif
+		}
+#endif
 		printf("\n");
 	}
 #endif
@@ -563,13 +591,73 @@ void * PF_CONVENTION powerpc_cpu::compile_chain_block(block_info *sbi)
 
 	const uint32 tpc = sbi->li[n].jmp_pc;
 	block_info *tbi = my_block_cache.find(tpc);
-	if (tbi == NULL)
+#if PPC_ENABLE_SUPERBLOCKS
+	// Don't link back-edges to loop headers until they get hot, then
+	// retranslate the header as a superblock. The link will be
+	// resolved to it next time
+	if (tbi && !tbi->superblock && tpc <= sbi->end_pc) {
+		if (++tbi->count < SUPERBLOCK_THRESHOLD)
+			return tbi->entry_point;
+		chain_source_block = sbi;
+		tbi = compile_superblock(tpc);
+		chain_source_block = NULL;
+		return tbi->entry_point;
+	}
+#endif
+	if (tbi == NULL) {
+		// Don't let the translation cache reclaim the trampoline we return to
+		chain_source_block = sbi;
 		tbi = compile_block(tpc);
+		if (chain_source_block == NULL) {
+			// Source block was dropped from the cache, nothing to patch
+			return tbi->entry_point;
+		}
+		chain_source_block = NULL;
+	}
 	assert(tbi && tbi->pc == tpc);
 
 	dg_set_jmp_target(sbi->li[n].jmp_addr, tbi->entry_point);
 	return tbi->entry_point;
 }
+
+#if PPC_ENABLE_SUPERBLOCKS
+// Predicate to select the blocks starting at PC, except the superblock
+struct superblock_predecessor {
+	const uintptr pc;
+	const powerpc_block_info * const sbi;
+	superblock_predecessor(uintptr p, const powerpc_block_info *b)
+		: pc(p), sbi(b) { }
+	bool operator()(const powerpc_block_info *bi) const
+		{ return bi->pc == pc && bi != sbi; }
+};
+
+// Reset the direct links to PC, they will get resolved again
+struct superblock_unlink {
+	const uintptr pc;
+	superblock_unlink(uintptr p)
+		: pc(p) { }
+	void operator()(powerpc_block_info *bi) const {
+		for (int i = 0; i < powerpc_block_info::MAX_TARGETS; i++) {
+			powerpc_block_info::link_info * const tli = &bi->li[i];
+			if (tli->jmp_pc == pc)
+				dg_set_jmp_target(tli->jmp_addr, tli->jmp_resolve_addr);
+		}
+	}
+};
+
+powerpc_cpu::block_info *
+powerpc_cpu::compile_superblock(uint32 entry)
+{
+	block_info *sbi = compile_block(entry, true);
+
+	// Retire the block it replaces. The code of the latter is kept
+	// until the translation cache region is reclaimed, as we may be
+	// returning to its trampoline
+	my_block_cache.clear_if(superblock_predecessor(entry, sbi));
+	my_block_cache.for_each(superblock_unlink(entry));
+	return sbi;
+}
+#endif
 #endif
 
 void powerpc_cpu::execute(uint32 entry)
@@ -611,8 +699,9 @@ void powerpc_cpu::execute(uint32 entry)
 						break;
 				}
 
-				// Compile new block
-				bi = compile_block(pc());
+				// Compile new block, unless it survived cache reclamation
+				if ((bi = my_block_cache.find(pc())) == NULL)
+					bi = compile_block(pc());
 			}
 		}
 #endif
@@ -663,12 +752,8 @@ void powerpc_cpu::execute(uint32 entry)
 				}
 #endif
 				if (di >= decode_cache_end_p) {
-					// Invalidate cache and move current code to start
-					invalidate_cache();
-					const int blocklen = di - bi->di;
-					memmove(decode_cache_p, bi->di, blocklen * sizeof(*di));
-					bi->di = decode_cache_p;
-					di = bi->di + blocklen;
+					// Reclaim oldest segment, current code may be moved to start
+					di = reclaim_decode_cache(bi, di);
 				}
 			} while ((ii->cflow & CFLOW_END_BLOCK) == 0);
 			bi->end_pc = dpc;
@@ -759,33 +844,98 @@ void powerpc_cpu::execute()
 void powerpc_cpu::init_decode_cache()
 {
 #if PPC_DECODE_CACHE
-	decode_cache = (block_info::decode_info *)vm_acquire(DECODE_CACHE_SIZE);
+	const uint32 decode_cache_size = decode_cache_entries * sizeof(block_info::decode_info);
+	decode_cache = (block_info::decode_info *)vm_acquire(decode_cache_size);
 	if (decode_cache == VM_MAP_FAILED) {
 		fprintf(stderr, "powerpc_cpu: Could not allocate decode cache\n");
 		abort();
 	}
 
-	D(bug("powerpc_cpu: Allocated decode cache: %d KB at %p\n", DECODE_CACHE_SIZE / 1024, decode_cache));
+	D(bug("powerpc_cpu: Allocated decode cache: %d KB at %p\n", decode_cache_size / 1024, decode_cache));
 	decode_cache_p = decode_cache;
-	decode_cache_end_p = decode_cache + DECODE_CACHE_MAX_ENTRIES;
-#if FLIGHT_RECORDER
-	// Leave enough room to last call to record_step()
-	decode_cache_end_p -= 2;
-#endif
-#if PPC_EXECUTE_DUMP_STATE
-	// Leave enough room to last calls to dump state functions
-	decode_cache_end_p -= 2;
-#endif
+	decode_cache_reclaim_p = decode_cache + decode_cache_entries;
+	// Leave enough room to last calls to record_step() and dump state functions
+	decode_cache_end_p = decode_cache_reclaim_p - DECODE_CACHE_MARGIN;
+	decode_cache_reclaimed_segments = 0;
 #endif
 }
 
 void powerpc_cpu::kill_decode_cache()
 {
 #if PPC_DECODE_CACHE
-	vm_release(decode_cache, DECODE_CACHE_SIZE);
+	D(bug("powerpc_cpu: Reclaimed %u decode cache segments\n", decode_cache_reclaimed_segments));
+	vm_release(decode_cache, decode_cache_entries * sizeof(block_info::decode_info));
 #endif
 }
 
+#if PPC_DECODE_CACHE
+void powerpc_cpu::set_decode_cache_size(uint32 size)
+{
+	uint32 entries = size / sizeof(block_info::decode_info);
+	if (entries < DECODE_CACHE_MIN_ENTRIES)
+		entries = DECODE_CACHE_MIN_ENTRIES;
+	if (entries == decode_cache_entries)
+		return;
+
+	// Drop all predecoded blocks and reallocate decode cache
+	invalidate_cache();
+	kill_decode_cache();
+	decode_cache_entries = entries;
+	init_decode_cache();
+}
+
+// Predicate to select the blocks that occupy a range of the decode cache
+struct decode_cache_range {
+	const powerpc_block_info::decode_info *start, *end;
+	decode_cache_range(const powerpc_block_info::decode_info *s, const powerpc_block_info::decode_info *e)
+		: start(s), end(e) { }
+	bool operator()(const powerpc_block_info *bi) const
+		{ return bi->di && bi->di < end && bi->di + bi->size > start; }
+};
+
+void powerpc_cpu::reclaim_decode_cache_segment()
+{
+	block_info::decode_info * const cache_end = decode_cache + decode_cache_entries;
+	block_info::decode_info *start = decode_cache_reclaim_p;
+	block_info::decode_info *end = start + decode_cache_entries / DECODE_CACHE_SEGMENTS;
+	if (end > cache_end)
+		end = cache_end;
+	D(bug("Reclaim decode cache segment [%p - %p]\n", start, end));
+
+	my_block_cache.clear_if(decode_cache_range(start, end));
+	spcflags().set(SPCFLAG_JIT_EXEC_RETURN);
+	decode_cache_reclaim_p = end;
+	decode_cache_end_p = end - DECODE_CACHE_MARGIN;
+	decode_cache_reclaimed_segments++;
+}
+
+powerpc_cpu::block_info::decode_info *powerpc_cpu::reclaim_decode_cache(block_info *bi, block_info::decode_info *di)
+{
+	const int blocklen = di - bi->di;
+	if (decode_cache_reclaim_p < decode_cache + decode_cache_entries) {
+		// Free space ends at the oldest segment in use, reclaim it
+		reclaim_decode_cache_segment();
+		return di;
+	}
+
+	// End of decode cache reached, wrap around
+	if (blocklen + DECODE_CACHE_MARGIN >= decode_cache_entries / 2) {
+		// Current block too long to be moved, invalidate everything
+		invalidate_cache();
+		decode_cache_reclaim_p = decode_cache + decode_cache_entries;
+	}
+	else {
+		decode_cache_reclaim_p = decode_cache;
+		do {
+			reclaim_decode_cache_segment();
+		} while (decode_cache_end_p <= decode_cache + blocklen);
+	}
+	memmove(decode_cache, bi->di, blocklen * sizeof(*di));
+	decode_cache_p = bi->di = decode_cache;
+	return bi->di + blocklen;
+}
+#endif
+
 void powerpc_cpu::invalidate_cache()
 {
 	D(bug("Invalidate all cache blocks\n"));
@@ -796,12 +946,77 @@ void powerpc_cpu::invalidate_cache()
 #endif
 #if PPC_ENABLE_JIT
 	codegen.invalidate_cache();
+#if PPC_PROFILE_COMPILE_TIME
+	cache_flush_count++;
+#endif
 #endif
 #if PPC_DECODE_CACHE
 	decode_cache_p = decode_cache;
 #endif
 }
 
+#if PPC_ENABLE_JIT
+// Predicate to select the blocks compiled into a range of the translation cache
+struct translation_cache_range {
+	const uint8 *start, *end;
+	translation_cache_range(const uint8 *s, const uint8 *e)
+		: start(s), end(e) { }
+	bool operator()(const powerpc_block_info *bi) const
+		{ return bi->entry_point >= start && bi->entry_point < end; }
+};
+
+#if DYNGEN_DIRECT_BLOCK_CHAINING
+// Reset the direct links into the blocks of a range of the translation cache
+template< class Cache >
+struct translation_cache_unchain {
+	Cache & cache;
+	translation_cache_range range;
+	translation_cache_unchain(Cache & c, const translation_cache_range & r)
+		: cache(c), range(r) { }
+	void operator()(powerpc_block_info *bi) const {
+		if (range(bi))
+			return;
+		for (int i = 0; i < powerpc_block_info::MAX_TARGETS; i++) {
+			powerpc_block_info::link_info * const tli = &bi->li[i];
+			if (tli->jmp_pc == powerpc_block_info::INVALID_PC)
+				continue;
+			powerpc_block_info *tbi = cache.find(tli->jmp_pc);
+			if (tbi && range(tbi))
+				dg_set_jmp_target(tli->jmp_addr, tli->jmp_resolve_addr);
+		}
+	}
+};
+#endif
+
+bool powerpc_cpu::reclaim_translation_cache()
+{
+	bool restart = false;
+	do {
+		uint8 *start, *end;
+		if (codegen.reclaim_region(&start, &end))
+			restart = true;
+#if PPC_PROFILE_COMPILE_TIME
+		cache_reclaim_count++;
+#endif
+		D(bug("Reclaim translation cache region [%p - %p]\n", start, end));
+
+		const translation_cache_range range(start, end);
+#if DYNGEN_DIRECT_BLOCK_CHAINING
+		my_block_cache.for_each(translation_cache_unchain< block_cache< block_info, lazy_allocator > >(my_block_cache, range));
+		if (chain_source_block && range(chain_source_block)) {
+			// Keep the trampoline compile_chain_block() returns to
+			codegen.skip_code(chain_source_block->entry_point + chain_source_block->size);
+			chain_source_block = NULL;
+			restart = true;
+		}
+#endif
+		my_block_cache.clear_if(range);
+	} while (codegen.full_translation_cache());
+	spcflags().set(SPCFLAG_JIT_EXEC_RETURN);
+	return restart;
+}
+#endif
+
 void powerpc_block_info::invalidate()
 {
 #if PPC_DECODE_CACHE
@@ -205,6 +205,16 @@ private:
 	uint32 compile_count;
 	clock_t compile_time;
 	clock_t emul_start_time;
+#if PPC_ENABLE_JIT
+	uint32 cache_flush_count;
+	uint32 cache_reclaim_count;
+	uint32 cr_update_count;
+	uint32 cr_eliminated_count;
+#if PPC_ENABLE_SUPERBLOCKS
+	uint32 superblock_count;
+	uint32 side_exit_count;
+#endif
+#endif
 #endif
 
 	// Compile blocks statistics
@@ -356,12 +366,19 @@ private:
 	block_cache< block_info, lazy_allocator > my_block_cache;
 
 #if PPC_DECODE_CACHE
-	// Decode Cache
+	// Decode Cache, reclaimed one segment at a time (oldest first) when full
 	static const uint32 DECODE_CACHE_MAX_ENTRIES = 32768;
-	static const uint32 DECODE_CACHE_SIZE = DECODE_CACHE_MAX_ENTRIES * sizeof(block_info::decode_info);
+	static const uint32 DECODE_CACHE_MIN_ENTRIES = 4096;
+	static const uint32 DECODE_CACHE_SEGMENTS = 8;
+	static const uint32 DECODE_CACHE_MARGIN = (PPC_FLIGHT_RECORDER ? 2 : 0) + (PPC_EXECUTE_DUMP_STATE ? 2 : 0);
 	block_info::decode_info * decode_cache;
-	block_info::decode_info * decode_cache_p;
-	block_info::decode_info * decode_cache_end_p;
+	block_info::decode_info * decode_cache_p;					// Next free entry
+	block_info::decode_info * decode_cache_end_p;				// Limit of free entries (minus margin)
+	void reclaim_decode_cache_segment();
+	block_info::decode_info * reclaim_decode_cache(block_info *bi, block_info::decode_info *di);
+public:
+	void set_decode_cache_size(uint32 size);
+private:
 #endif
 
 #if PPC_ENABLE_JIT
@@ -370,12 +387,29 @@ private:
 	friend class powerpc_dyngen;
 	friend class powerpc_jit;
 	powerpc_jit codegen;
-	block_info *compile_block(uint32 entry);
+	block_info *compile_block(uint32 entry, bool superblock = false);
+	bool reclaim_translation_cache();
 	static void call_do_record_step(powerpc_cpu * cpu, uint32 pc, uint32 opcode);
 #if DYNGEN_DIRECT_BLOCK_CHAINING
+	block_info *chain_source_block;		// Block whose link is being resolved
 	void *compile_chain_block(block_info *sbi);
 	static void * call_compile_chain_block(powerpc_cpu * the_cpu, block_info *sbi);
+#if PPC_ENABLE_SUPERBLOCKS
+	// Superblocks are formed at loop headers once their back-edge
+	// was taken SUPERBLOCK_THRESHOLD times
+	static const int32 SUPERBLOCK_THRESHOLD = 32;
+	static const int SUPERBLOCK_MAX_SIDE_EXITS = 8;
+	block_info *compile_superblock(uint32 entry);
 #endif
+#endif
+#endif
+
+	// NOTE: precompiled dyngen ops access codegen members at fixed
+	// offsets, data members added to powerpc_cpu must follow codegen
+#if PPC_DECODE_CACHE
+	uint32 decode_cache_entries;
+	block_info::decode_info * decode_cache_reclaim_p;			// Start of oldest segment still in use
+	uint32 decode_cache_reclaimed_segments;
 #endif
 
 	// Semantic action templates
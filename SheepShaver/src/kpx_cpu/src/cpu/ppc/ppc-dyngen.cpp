@@ -37,6 +37,7 @@
 powerpc_dyngen::powerpc_dyngen(dyngen_cpu_base cpu)
 	: basic_dyngen(cpu)
 {
+	reg_cache_reset();
 #ifdef SHEEPSHAVER
 	printf("Detected CPU features:");
 	if (cpuinfo_check_mmx())
@@ -64,37 +65,46 @@ uint8 *powerpc_dyngen::gen_start(uint32 pc)
 	gen_exec_return();
 	dg_set_jmp_target_noflush(jmp_addr[0], gen_align());
 	jmp_addr[0] = NULL;
+	reg_cache_reset();
 	return p;
 }
 
 void powerpc_dyngen::gen_compare_T0_T1(int crf)
 {
+	reg_cache_sync();
 	gen_op_compare_T0_T1();
 	gen_store_T0_crf(crf);
+	reg_cache_clobber(0);
 }
 
 void powerpc_dyngen::gen_compare_T0_im(int crf, int32 value)
 {
+	reg_cache_sync();
 	if (value == 0)
 		gen_op_compare_T0_0();
 	else
 		gen_op_compare_T0_im(value);
 	gen_store_T0_crf(crf);
+	reg_cache_clobber(0);
 }
 
 void powerpc_dyngen::gen_compare_logical_T0_T1(int crf)
 {
+	reg_cache_sync();
 	gen_op_compare_logical_T0_T1();
 	gen_store_T0_crf(crf);
+	reg_cache_clobber(0);
 }
 
 void powerpc_dyngen::gen_compare_logical_T0_im(int crf, int32 value)
 {
+	reg_cache_sync();
 	if (value == 0)
 		gen_op_compare_logical_T0_0();
 	else
 		gen_op_compare_logical_T0_im(value);
 	gen_store_T0_crf(crf);
+	reg_cache_clobber(0);
 }
 
 void powerpc_dyngen::gen_mtcrf_T0_im(uint32 mask)
@@ -131,8 +141,8 @@ DEFINE_INSN(stmw);
  *		Load/store registers
  **/
 
-#define DEFINE_INSN(OP, REG, REGT)						\
-void powerpc_dyngen::gen_##OP##_##REG##_##REGT(int i)	\
+#define DEFINE_INSN_RAW(NAME, OP, REG, REGT)			\
+void powerpc_dyngen::NAME(int i)						\
 {														\
 	switch (i) {										\
 	case 0: gen_op_##OP##_##REG##_##REGT##0(); break;	\
@@ -170,14 +180,16 @@ void powerpc_dyngen::gen_##OP##_##REG##_##REGT(int i)	\
 	default: abort();									\
 	}													\
 }
-
-// General purpose registers
-DEFINE_INSN(load, T0, GPR);
-DEFINE_INSN(load, T1, GPR);
-DEFINE_INSN(load, T2, GPR);
-DEFINE_INSN(store, T0, GPR);
-DEFINE_INSN(store, T1, GPR);
-DEFINE_INSN(store, T2, GPR);
+#define DEFINE_INSN(OP, REG, REGT) \
+		DEFINE_INSN_RAW(gen_##OP##_##REG##_##REGT, OP, REG, REGT)
+
+// General purpose registers (uncached)
+DEFINE_INSN_RAW(do_gen_load_T0_GPR, load, T0, GPR);
+DEFINE_INSN_RAW(do_gen_load_T1_GPR, load, T1, GPR);
+DEFINE_INSN_RAW(do_gen_load_T2_GPR, load, T2, GPR);
+DEFINE_INSN_RAW(do_gen_store_T0_GPR, store, T0, GPR);
+DEFINE_INSN_RAW(do_gen_store_T1_GPR, store, T1, GPR);
+DEFINE_INSN_RAW(do_gen_store_T2_GPR, store, T2, GPR);
 DEFINE_INSN(load, F0, FPR);
 DEFINE_INSN(load, F1, FPR);
 DEFINE_INSN(load, F2, FPR);
@@ -197,6 +209,59 @@ DEFINE_INSN(store, T0, crb);
 DEFINE_INSN(store, T1, crb);
 
 #undef DEFINE_INSN
+#undef DEFINE_INSN_RAW
+
+// Load GPR i into Tt, unless it is already there or in another T register
+void powerpc_dyngen::gen_load_Tn_GPR(int t, int i)
+{
+	reg_cache_sync();
+	const uint32 m = 1 << i;
+	if (!(reg_cache[t] & m)) {
+		int s = -1;
+		for (int n = 0; n < 3; n++) {
+			if (reg_cache[n] & m)
+				s = n;
+		}
+		switch (t) {
+		case 0:
+			if (s == 1) gen_mov_32_T0_T1();
+			else if (s == 2) gen_mov_32_T0_T2();
+			else do_gen_load_T0_GPR(i);
+			break;
+		case 1:
+			if (s == 0) gen_mov_32_T1_T0();
+			else if (s == 2) gen_mov_32_T1_T2();
+			else do_gen_load_T1_GPR(i);
+			break;
+		case 2:
+			if (s == 0) gen_mov_32_T2_T0();
+			else if (s == 1) gen_mov_32_T2_T1();
+			else do_gen_load_T2_GPR(i);
+			break;
+		default:
+			abort();
+		}
+		reg_cache[t] = m;
+	}
+	reg_cache_code_ptr = code_ptr();
+}
+
+// Store Tt into GPR i, Tt then holds the only valid copy of it
+void powerpc_dyngen::gen_store_Tn_GPR(int t, int i)
+{
+	reg_cache_sync();
+	switch (t) {
+	case 0: do_gen_store_T0_GPR(i); break;
+	case 1: do_gen_store_T1_GPR(i); break;
+	case 2: do_gen_store_T2_GPR(i); break;
+	default: abort();
+	}
+	const uint32 m = 1 << i;
+	for (int n = 0; n < 3; n++)
+		reg_cache[n] &= ~m;
+	reg_cache[t] |= m;
+	reg_cache_code_ptr = code_ptr();
+}
 
 // Floating point load store
 #define DEFINE_OP(NAME, REG, TYPE)										\
@@ -236,7 +301,7 @@ DEFINE_INSN(store, T0);
 
 #undef DEFINE_INSN
 
-void powerpc_dyngen::gen_bc(int bo, int bi, uint32 tpc, uint32 npc, bool direct_chaining)
+void powerpc_dyngen::gen_prep_branch(int bo, int bi)
 {
 	if (BO_CONDITIONAL_BRANCH(bo))
 		gen_load_T1_crb(bi);
@@ -262,7 +327,12 @@ void powerpc_dyngen::gen_bc(int bo, int bi, uint32 tpc, uint32 npc, bool direct_
 #undef _
 	default: abort();
 	}
-	
+}
+
+void powerpc_dyngen::gen_bc(int bo, int bi, uint32 tpc, uint32 npc, bool direct_chaining)
+{
+	gen_prep_branch(bo, bi);
+
 	if (BO_CONDITIONAL_BRANCH(bo) || BO_DECREMENT_CTR(bo)) {
 		// two-way branches
 		if (direct_chaining)
@@ -287,6 +357,30 @@ void powerpc_dyngen::gen_bc(int bo, int bi, uint32 tpc, uint32 npc, bool direct_
 	}
 }
 
+// Two-way branch that only leaves the block in one direction: the
+// side exit sets PC to XPC then looks up the next block from SB, and
+// code generation goes on with the other direction
+void powerpc_dyngen::gen_bc_side_exit(int bo, int bi, bool exit_if_taken, uint32 xpc, uintptr sb)
+{
+	// T0 is preserved, T1 gets the condition and T2 the new CTR
+	reg_cache_sync();
+	gen_prep_branch(bo, bi);
+	gen_op_branch_chain_2();
+	uint8 *exit_jmp_addr = jmp_addr[exit_if_taken ? 0 : 1];
+	uint8 *cont_jmp_addr = jmp_addr[exit_if_taken ? 1 : 0];
+	jmp_addr[0] = jmp_addr[1] = NULL;
+
+	dg_set_jmp_target_noflush(exit_jmp_addr, gen_align());
+	gen_set_PC_im(xpc);
+	gen_mov_ad_A0_im(sb);
+	gen_jump_next_A0();
+	gen_exec_return();
+
+	dg_set_jmp_target_noflush(cont_jmp_addr, gen_align());
+	reg_cache[1] = reg_cache[2] = 0;
+	reg_cache_code_ptr = code_ptr();
+}
+
 /**
  *		Vector instructions
  **/
@@ -41,6 +41,33 @@ class powerpc_dyngen
 	powerpc_fpr reg_F3;
 //#endif
 
+	// Host register cache: GPRs (bitmask) known to be held in T0-T2.
+	// Stores are written through, so only redundant loads are removed
+	// and nothing needs to be spilled at block exits or on faults.
+	// The cache is dropped as soon as untracked code is generated.
+	uint32 reg_cache[3];
+	uint8 *reg_cache_code_ptr;
+
+	void reg_cache_reset()
+		{ reg_cache[0] = reg_cache[1] = reg_cache[2] = 0; reg_cache_code_ptr = code_ptr(); }
+	void reg_cache_sync()
+		{ if (code_ptr() != reg_cache_code_ptr) reg_cache_reset(); }
+	void reg_cache_clobber(int t)
+		{ if (t >= 0) reg_cache[t] = 0; reg_cache_code_ptr = code_ptr(); }
+	void reg_cache_invalidate(uint32 gprs)	// after native code leaving T0-T2 alone
+		{ for (int n = 0; n < 3; n++) reg_cache[n] &= ~gprs; reg_cache_code_ptr = code_ptr(); }
+	void gen_load_Tn_GPR(int t, int i);
+	void gen_store_Tn_GPR(int t, int i);
+	void do_gen_load_T0_GPR(int i);
+	void do_gen_load_T1_GPR(int i);
+	void do_gen_load_T2_GPR(int i);
+	void do_gen_store_T0_GPR(int i);
+	void do_gen_store_T1_GPR(int i);
+	void do_gen_store_T2_GPR(int i);
+
+	// Compute branch condition into T1, decrementing CTR as needed
+	void gen_prep_branch(int bo, int bi);
+
 	// Code generators for PowerPC synthetic instructions
 #ifndef NO_DEFINE_ALIAS
 #	define DEFINE_GEN(NAME,RET,ARGS) RET NAME ARGS;
@@ -61,12 +88,12 @@ public:
 	uint8 *gen_start(uint32 pc);
 
 	// Load/store registers
-	void gen_load_T0_GPR(int i);
-	void gen_load_T1_GPR(int i);
-	void gen_load_T2_GPR(int i);
-	void gen_store_T0_GPR(int i);
-	void gen_store_T1_GPR(int i);
-	void gen_store_T2_GPR(int i);
+	void gen_load_T0_GPR(int i)		{ gen_load_Tn_GPR(0, i); }
+	void gen_load_T1_GPR(int i)		{ gen_load_Tn_GPR(1, i); }
+	void gen_load_T2_GPR(int i)		{ gen_load_Tn_GPR(2, i); }
+	void gen_store_T0_GPR(int i)	{ gen_store_Tn_GPR(0, i); }
+	void gen_store_T1_GPR(int i)	{ gen_store_Tn_GPR(1, i); }
+	void gen_store_T2_GPR(int i)	{ gen_store_Tn_GPR(2, i); }
 	void gen_load_F0_FPR(int i);
 	void gen_load_F1_FPR(int i);
 	void gen_load_F2_FPR(int i);
@@ -89,10 +116,55 @@ public:
 #define DEFINE_ALIAS_3(NAME,PRE,POST)	DEFINE_ALIAS_RAW(NAME,PRE,POST,(long p1,long p2,long p3),(p1,p2,p3))
 #ifdef NO_DEFINE_ALIAS
 #define DEFINE_ALIAS(NAME,N)
+#define DEFINE_ALIAS_CLOBBER(NAME,N,T)
 #else
 #define DEFINE_ALIAS(NAME,N)			DEFINE_ALIAS_##N(NAME,,)
+#define DEFINE_ALIAS_CLOBBER(NAME,N,T)	DEFINE_ALIAS_##N(NAME,reg_cache_sync(),reg_cache_clobber(T))
 #endif
 
+	// Basic operations known to the register cache, T is the
+	// register they write to (-1 if none)
+#define DEFINE_BASIC_RAW(NAME, T, ARGLIST, ARGS) \
+	void gen_##NAME ARGLIST { reg_cache_sync(); basic_dyngen::gen_##NAME ARGS; reg_cache_clobber(T); }
+#define DEFINE_BASIC_0(NAME,T)			DEFINE_BASIC_RAW(NAME,T,(),())
+#define DEFINE_BASIC_1(NAME,T)			DEFINE_BASIC_RAW(NAME,T,(long p1),(p1))
+
+	DEFINE_BASIC_1(mov_32_T0_im,0);
+	DEFINE_BASIC_1(mov_32_T1_im,1);
+	DEFINE_BASIC_0(add_32_T0_T1,0);
+	DEFINE_BASIC_1(add_32_T0_im,0);
+	DEFINE_BASIC_0(add_32_T1_T2,1);
+	DEFINE_BASIC_1(add_32_T1_im,1);
+	DEFINE_BASIC_0(and_32_T0_T1,0);
+	DEFINE_BASIC_1(and_32_T0_im,0);
+	DEFINE_BASIC_0(or_32_T0_T1,0);
+	DEFINE_BASIC_1(or_32_T0_im,0);
+	DEFINE_BASIC_0(xor_32_T0_T1,0);
+	DEFINE_BASIC_1(xor_32_T0_im,0);
+	DEFINE_BASIC_1(lsl_32_T0_im,0);
+	DEFINE_BASIC_1(lsr_32_T0_im,0);
+	DEFINE_BASIC_1(rol_32_T0_im,0);
+	DEFINE_BASIC_0(se_8_32_T0,0);
+	DEFINE_BASIC_0(se_16_32_T0,0);
+	DEFINE_BASIC_0(load_u32_T0_T1_T2,0);
+	DEFINE_BASIC_1(load_u32_T0_T1_im,0);
+	DEFINE_BASIC_0(load_u16_T0_T1_T2,0);
+	DEFINE_BASIC_1(load_u16_T0_T1_im,0);
+	DEFINE_BASIC_0(load_s16_T0_T1_T2,0);
+	DEFINE_BASIC_1(load_s16_T0_T1_im,0);
+	DEFINE_BASIC_0(load_u8_T0_T1_T2,0);
+	DEFINE_BASIC_1(load_u8_T0_T1_im,0);
+	DEFINE_BASIC_0(store_32_T0_T1_T2,-1);
+	DEFINE_BASIC_1(store_32_T0_T1_im,-1);
+	DEFINE_BASIC_0(store_16_T0_T1_T2,-1);
+	DEFINE_BASIC_1(store_16_T0_T1_im,-1);
+	DEFINE_BASIC_0(store_8_T0_T1_T2,-1);
+	DEFINE_BASIC_1(store_8_T0_T1_im,-1);
+
+#undef DEFINE_BASIC_0
+#undef DEFINE_BASIC_1
+#undef DEFINE_BASIC_RAW
+
 	// Misc instructions
 #if KPX_MAX_CPUS == 1
 	DEFINE_ALIAS(lwarx_T0_T1,0);
@@ -139,7 +211,7 @@ public:
 	DEFINE_ALIAS(jump_next_A0,0);
 
 	// Compare & Record instructions
-	DEFINE_ALIAS(record_cr0_T0,0);
+	DEFINE_ALIAS_CLOBBER(record_cr0_T0,0,-1);
 	DEFINE_ALIAS(record_cr1,0);
 	void gen_compare_T0_T1(int crf);
 	void gen_compare_T0_im(int crf, int32 value);
@@ -162,7 +234,7 @@ public:
 	DEFINE_ALIAS(sraw_T0_T1,0);
 	DEFINE_ALIAS(sraw_T0_im,1);
 	DEFINE_ALIAS(rlwimi_T0_T1,2);
-	DEFINE_ALIAS(rlwinm_T0_T1,2);
+	DEFINE_ALIAS_CLOBBER(rlwinm_T0_T1,2,0);
 	DEFINE_ALIAS(rlwnm_T0_T1,1);
 	DEFINE_ALIAS(cntlzw_32_T0,0);
 
@@ -177,7 +249,7 @@ public:
 	DEFINE_ALIAS(addmeo_T0,0);
 	DEFINE_ALIAS(addze_T0,0);
 	DEFINE_ALIAS(addzeo_T0,0);
-	DEFINE_ALIAS(subf_T0_T1,0);
+	DEFINE_ALIAS_CLOBBER(subf_T0_T1,0,0);
 	DEFINE_ALIAS(subfo_T0_T1,0);
 	DEFINE_ALIAS(subfc_T0_im,1);
 	DEFINE_ALIAS(subfc_T0_T1,0);
@@ -233,6 +305,7 @@ public:
 
 	// Branch instructions
 	void gen_bc(int bo, int bi, uint32 tpc, uint32 npc, bool direct_chaining);
+	void gen_bc_side_exit(int bo, int bi, bool exit_if_taken, uint32 xpc, uintptr sb);
 
 	// Vector instructions
 	void gen_load_ad_VD_VR(int i);
@@ -248,6 +321,7 @@ public:
 	DEFINE_ALIAS(mtvscr_V0,0);
 
 #undef DEFINE_ALIAS
+#undef DEFINE_ALIAS_CLOBBER
 #undef DEFINE_ALIAS_0
 #undef DEFINE_ALIAS_1
 #undef DEFINE_ALIAS_2
@@ -44,6 +44,14 @@ static x86_memory_operand vm_memory_operand(int32 d, int b, int i = X86_NOREG, i
 	return x86_memory_operand(d + VMBaseDiff, b, i, s);
 }
 
+// Load/store handler options
+enum {
+	JIT_MEM_SIZE_MASK	= 0x0f,		// access size in bytes
+	JIT_MEM_SIGN		= 0x10,		// sign extend loaded value
+	JIT_MEM_UPDATE		= 0x20,		// write effective address back to rA
+	JIT_MEM_INDEXED		= 0x40,		// effective address is (rA|0) + rB
+};
+
 bool powerpc_jit::initialize(void)
 {
 	if (!powerpc_dyngen::initialize())
@@ -107,6 +115,59 @@ bool powerpc_jit::initialize(void)
 		for (int i = 0; i < sizeof(x86_vector) / sizeof(x86_vector[0]); i++)
 			jit_info[x86_vector[i].mnemo] = &x86_vector[i];
 
+		// x86 load/store handlers
+		static const jit_info_t x86_load_store[] = {
+#define DEFINE_OP(MNEMO, GEN_OP, SIZE, OPT) \
+			{ PPC_I(MNEMO), (gen_handler_t)&powerpc_jit::gen_x86_##GEN_OP, (SIZE) | (OPT) }
+			DEFINE_OP(LBZ,		load,	1, 0),
+			DEFINE_OP(LBZU,		load,	1, JIT_MEM_UPDATE),
+			DEFINE_OP(LBZUX,	load,	1, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(LBZX,		load,	1, JIT_MEM_INDEXED),
+			DEFINE_OP(LHA,		load,	2, JIT_MEM_SIGN),
+			DEFINE_OP(LHAU,		load,	2, JIT_MEM_SIGN | JIT_MEM_UPDATE),
+			DEFINE_OP(LHAUX,	load,	2, JIT_MEM_SIGN | JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(LHAX,		load,	2, JIT_MEM_SIGN | JIT_MEM_INDEXED),
+			DEFINE_OP(LHZ,		load,	2, 0),
+			DEFINE_OP(LHZU,		load,	2, JIT_MEM_UPDATE),
+			DEFINE_OP(LHZUX,	load,	2, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(LHZX,		load,	2, JIT_MEM_INDEXED),
+			DEFINE_OP(LWZ,		load,	4, 0),
+			DEFINE_OP(LWZU,		load,	4, JIT_MEM_UPDATE),
+			DEFINE_OP(LWZUX,	load,	4, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(LWZX,		load,	4, JIT_MEM_INDEXED),
+			DEFINE_OP(STB,		store,	1, 0),
+			DEFINE_OP(STBU,		store,	1, JIT_MEM_UPDATE),
+			DEFINE_OP(STBUX,	store,	1, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(STBX,		store,	1, JIT_MEM_INDEXED),
+			DEFINE_OP(STH,		store,	2, 0),
+			DEFINE_OP(STHU,		store,	2, JIT_MEM_UPDATE),
+			DEFINE_OP(STHUX,	store,	2, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(STHX,		store,	2, JIT_MEM_INDEXED),
+			DEFINE_OP(STW,		store,	4, 0),
+			DEFINE_OP(STWU,		store,	4, JIT_MEM_UPDATE),
+			DEFINE_OP(STWUX,	store,	4, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(STWX,		store,	4, JIT_MEM_INDEXED),
+			DEFINE_OP(LFD,		lfd,	8, 0),
+			DEFINE_OP(LFDU,		lfd,	8, JIT_MEM_UPDATE),
+			DEFINE_OP(LFDUX,	lfd,	8, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(LFDX,		lfd,	8, JIT_MEM_INDEXED),
+			DEFINE_OP(STFD,		stfd,	8, 0),
+			DEFINE_OP(STFDU,	stfd,	8, JIT_MEM_UPDATE),
+			DEFINE_OP(STFDUX,	stfd,	8, JIT_MEM_UPDATE | JIT_MEM_INDEXED),
+			DEFINE_OP(STFDX,	stfd,	8, JIT_MEM_INDEXED),
+			DEFINE_OP(LMW,		lmw,	4, 0),
+			DEFINE_OP(STMW,		stmw,	4, 0)
+#undef DEFINE_OP
+		};
+
+		// Guest memory must be a flat mapping reachable through a 32-bit displacement
+#if !(defined(__APPLE__) && defined(__x86_64__)) && !defined(MEM_BULK)
+		if ((uintptr)(int32)VMBaseDiff == VMBaseDiff) {
+			for (int i = 0; i < sizeof(x86_load_store) / sizeof(x86_load_store[0]); i++)
+				jit_info[x86_load_store[i].mnemo] = &x86_load_store[i];
+		}
+#endif
+
 		// MMX optimized handlers
 		static const jit_info_t mmx_vector[] = {
 #define DEFINE_OP(MNEMO, GEN_OP, DYNGEN_OP) \
@@ -270,6 +331,13 @@ bool powerpc_jit::gen_vector_compare(int mnemo, int vD, int vA, int vB, bool Rc)
 }
 
 
+bool powerpc_jit::gen_load_store(int mnemo, int rS, int rA, int rB, int32 D)
+{
+	if (jit_info[mnemo]->handler == (gen_handler_t)&powerpc_jit::gen_not_available) return false;
+	return (this->*((bool (powerpc_jit::*)(int, int, int, int, int32))jit_info[mnemo]->handler))(mnemo, rS, rA, rB, D);
+}
+
+
 bool powerpc_jit::gen_not_available(int mnemo)
 {
 	return false;
@@ -366,6 +434,7 @@ static uint8 dummy_ppc_context[sizeof(powerpc_cpu)];
 #endif
 #define xPPC_FIELD(M)	(((uintptr)&xPPC_CONTEXT->M) - (uintptr)xPPC_CONTEXT)
 #define xPPC_GPR(N)		xPPC_FIELD(gpr(N))
+#define xPPC_FPR(N)		xPPC_FIELD(fpr(N))
 #define xPPC_VR(N)		xPPC_FIELD(vr(N))
 #define xPPC_CR			xPPC_FIELD(cr())
 #define xPPC_VSCR		xPPC_FIELD(vscr())
@@ -469,6 +538,249 @@ bool powerpc_jit::gen_x86_stvx(int mnemo, int vS, int rA, int rB)
 	return true;
 }
 
+/*
+ *	X86 load/store optimizations
+ *
+ *	EAX, ECX and EDX are not live across dyngen ops so they are used
+ *	as scratch registers here. GPRs are accessed in the CPU context,
+ *	this keeps T0-T2 and their register cache valid.
+ */
+
+// Compute effective address (rA|0) + rB, or (rA|0) + D, into EAX
+void powerpc_jit::gen_x86_ea(int rA, int rB, int32 D, uintptr opt)
+{
+	const bool use_rA = rA != 0 || (opt & JIT_MEM_UPDATE);
+	if (opt & JIT_MEM_INDEXED) {
+		gen_mov_32(x86_memory_operand(xPPC_GPR(rB), REG_CPU_ID), X86_EAX);
+		if (use_rA)
+			gen_add_32(x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID), X86_EAX);
+	}
+	else if (use_rA) {
+		gen_mov_32(x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID), X86_EAX);
+		if (D != 0)
+			gen_add_32(x86_immediate_operand(D), X86_EAX);
+	}
+	else
+		gen_mov_32(x86_immediate_operand(D), X86_EAX);
+}
+
+// lbz, lha, lhz, lwz and their update and indexed forms
+bool powerpc_jit::gen_x86_load(int mnemo, int rD, int rA, int rB, int32 D)
+{
+	const uintptr opt = jit_info[mnemo]->o.value;
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, opt);
+	const x86_memory_operand mem = vm_memory_operand(0, X86_EAX);
+	switch (opt & JIT_MEM_SIZE_MASK) {
+	case 1:
+		gen_mov_zx_8_32(mem, X86_ECX);
+		break;
+	case 2:
+		if (cpuinfo_check_movbe()) {
+			gen_movbe_16(mem, X86_CX);
+			if (opt & JIT_MEM_SIGN)
+				gen_mov_sx_16_32(X86_CX, X86_ECX);
+			else
+				gen_mov_zx_16_32(X86_CX, X86_ECX);
+		}
+		else {
+			gen_mov_zx_16_32(mem, X86_ECX);
+			gen_rol_16(x86_immediate_operand(8), X86_CX);
+			if (opt & JIT_MEM_SIGN)
+				gen_mov_sx_16_32(X86_CX, X86_ECX);
+		}
+		break;
+	case 4:
+		if (cpuinfo_check_movbe())
+			gen_movbe_32(mem, X86_ECX);
+		else {
+			gen_mov_32(mem, X86_ECX);
+			gen_bswap_32(X86_ECX);
+		}
+		break;
+	default:
+		abort();
+	}
+	gen_mov_32(X86_ECX, x86_memory_operand(xPPC_GPR(rD), REG_CPU_ID));
+	uint32 gprs = 1 << rD;
+	if (opt & JIT_MEM_UPDATE) {
+		gen_mov_32(X86_EAX, x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID));
+		gprs |= 1 << rA;
+	}
+	reg_cache_invalidate(gprs);
+	return true;
+}
+
+// stb, sth, stw and their update and indexed forms
+bool powerpc_jit::gen_x86_store(int mnemo, int rS, int rA, int rB, int32 D)
+{
+	const uintptr opt = jit_info[mnemo]->o.value;
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, opt);
+	gen_mov_32(x86_memory_operand(xPPC_GPR(rS), REG_CPU_ID), X86_ECX);
+	const x86_memory_operand mem = vm_memory_operand(0, X86_EAX);
+	switch (opt & JIT_MEM_SIZE_MASK) {
+	case 1:
+		gen_mov_8(X86_CL, mem);
+		break;
+	case 2:
+		if (cpuinfo_check_movbe())
+			gen_movbe_16(X86_CX, mem);
+		else {
+			gen_rol_16(x86_immediate_operand(8), X86_CX);
+			gen_mov_16(X86_CX, mem);
+		}
+		break;
+	case 4:
+		if (cpuinfo_check_movbe())
+			gen_movbe_32(X86_ECX, mem);
+		else {
+			gen_bswap_32(X86_ECX);
+			gen_mov_32(X86_ECX, mem);
+		}
+		break;
+	default:
+		abort();
+	}
+	uint32 gprs = 0;
+	if (opt & JIT_MEM_UPDATE) {
+		gen_mov_32(X86_EAX, x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID));
+		gprs |= 1 << rA;
+	}
+	reg_cache_invalidate(gprs);
+	return true;
+}
+
+// lfd and its update and indexed forms
+bool powerpc_jit::gen_x86_lfd(int mnemo, int frD, int rA, int rB, int32 D)
+{
+	const uintptr opt = jit_info[mnemo]->o.value;
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, opt);
+#if SIZEOF_VOID_P == 8
+	if (cpuinfo_check_movbe())
+		gen_movbe_64(vm_memory_operand(0, X86_EAX), X86_RCX);
+	else {
+		gen_mov_64(vm_memory_operand(0, X86_EAX), X86_RCX);
+		gen_bswap_64(X86_RCX);
+	}
+	gen_mov_64(X86_RCX, x86_memory_operand(xPPC_FPR(frD), REG_CPU_ID));
+#else
+	gen_mov_32(vm_memory_operand(0, X86_EAX), X86_ECX);
+	gen_mov_32(vm_memory_operand(4, X86_EAX), X86_EDX);
+	gen_bswap_32(X86_ECX);
+	gen_bswap_32(X86_EDX);
+	gen_mov_32(X86_ECX, x86_memory_operand(xPPC_FPR(frD) + 4, REG_CPU_ID));
+	gen_mov_32(X86_EDX, x86_memory_operand(xPPC_FPR(frD) + 0, REG_CPU_ID));
+#endif
+	uint32 gprs = 0;
+	if (opt & JIT_MEM_UPDATE) {
+		gen_mov_32(X86_EAX, x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID));
+		gprs |= 1 << rA;
+	}
+	reg_cache_invalidate(gprs);
+	return true;
+}
+
+// stfd and its update and indexed forms
+bool powerpc_jit::gen_x86_stfd(int mnemo, int frS, int rA, int rB, int32 D)
+{
+	const uintptr opt = jit_info[mnemo]->o.value;
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, opt);
+#if SIZEOF_VOID_P == 8
+	gen_mov_64(x86_memory_operand(xPPC_FPR(frS), REG_CPU_ID), X86_RCX);
+	if (cpuinfo_check_movbe())
+		gen_movbe_64(X86_RCX, vm_memory_operand(0, X86_EAX));
+	else {
+		gen_bswap_64(X86_RCX);
+		gen_mov_64(X86_RCX, vm_memory_operand(0, X86_EAX));
+	}
+#else
+	gen_mov_32(x86_memory_operand(xPPC_FPR(frS) + 4, REG_CPU_ID), X86_ECX);
+	gen_mov_32(x86_memory_operand(xPPC_FPR(frS) + 0, REG_CPU_ID), X86_EDX);
+	gen_bswap_32(X86_ECX);
+	gen_bswap_32(X86_EDX);
+	gen_mov_32(X86_ECX, vm_memory_operand(0, X86_EAX));
+	gen_mov_32(X86_EDX, vm_memory_operand(4, X86_EAX));
+#endif
+	uint32 gprs = 0;
+	if (opt & JIT_MEM_UPDATE) {
+		gen_mov_32(X86_EAX, x86_memory_operand(xPPC_GPR(rA), REG_CPU_ID));
+		gprs |= 1 << rA;
+	}
+	reg_cache_invalidate(gprs);
+	return true;
+}
+
+// lmw
+bool powerpc_jit::gen_x86_lmw(int mnemo, int rD, int rA, int rB, int32 D)
+{
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, 0);
+	int r = rD;
+#if SIZEOF_VOID_P == 8
+	// Two words at a time, GPRs are contiguous in the CPU context
+	for (; r < 31; r += 2) {
+		const x86_memory_operand mem = vm_memory_operand((r - rD) * 4, X86_EAX);
+		if (cpuinfo_check_movbe())
+			gen_movbe_64(mem, X86_RCX);
+		else {
+			gen_mov_64(mem, X86_RCX);
+			gen_bswap_64(X86_RCX);
+		}
+		gen_rol_64(x86_immediate_operand(32), X86_RCX);
+		gen_mov_64(X86_RCX, x86_memory_operand(xPPC_GPR(r), REG_CPU_ID));
+	}
+#endif
+	for (; r < 32; r++) {
+		const x86_memory_operand mem = vm_memory_operand((r - rD) * 4, X86_EAX);
+		if (cpuinfo_check_movbe())
+			gen_movbe_32(mem, X86_ECX);
+		else {
+			gen_mov_32(mem, X86_ECX);
+			gen_bswap_32(X86_ECX);
+		}
+		gen_mov_32(X86_ECX, x86_memory_operand(xPPC_GPR(r), REG_CPU_ID));
+	}
+	reg_cache_invalidate(0xffffffff << rD);
+	return true;
+}
+
+// stmw
+bool powerpc_jit::gen_x86_stmw(int mnemo, int rS, int rA, int rB, int32 D)
+{
+	reg_cache_sync();
+	gen_x86_ea(rA, rB, D, 0);
+	int r = rS;
+#if SIZEOF_VOID_P == 8
+	// Two words at a time, GPRs are contiguous in the CPU context
+	for (; r < 31; r += 2) {
+		const x86_memory_operand mem = vm_memory_operand((r - rS) * 4, X86_EAX);
+		gen_mov_64(x86_memory_operand(xPPC_GPR(r), REG_CPU_ID), X86_RCX);
+		gen_rol_64(x86_immediate_operand(32), X86_RCX);
+		if (cpuinfo_check_movbe())
+			gen_movbe_64(X86_RCX, mem);
+		else {
+			gen_bswap_64(X86_RCX);
+			gen_mov_64(X86_RCX, mem);
+		}
+	}
+#endif
+	for (; r < 32; r++) {
+		const x86_memory_operand mem = vm_memory_operand((r - rS) * 4, X86_EAX);
+		gen_mov_32(x86_memory_operand(xPPC_GPR(r), REG_CPU_ID), X86_ECX);
+		if (cpuinfo_check_movbe())
+			gen_movbe_32(X86_ECX, mem);
+		else {
+			gen_bswap_32(X86_ECX);
+			gen_mov_32(X86_ECX, mem);
+		}
+	}
+	reg_cache_invalidate(0);
+	return true;
+}
+
 /*
  *	MMX optimizations
  */
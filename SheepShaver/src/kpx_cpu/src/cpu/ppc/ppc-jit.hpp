@@ -37,6 +37,7 @@ struct powerpc_jit
 	bool gen_vector_2(int mnemo, int vD, int vA, int vB);
 	bool gen_vector_3(int mnemo, int vD, int vA, int vB, int vC);
 	bool gen_vector_compare(int mnemo, int vD, int vA, int vB, bool Rc);
+	bool gen_load_store(int mnemo, int rS, int rA, int rB, int32 D);
 
 private:
 	// Mid-level code generator info
@@ -68,6 +69,13 @@ private:
 	bool gen_vector_generic_store_word(int mnemo, int vS, int rA, int rB);
 
 #if defined(__i386__) || defined(__x86_64__)
+	void gen_x86_ea(int rA, int rB, int32 D, uintptr opt);
+	bool gen_x86_load(int mnemo, int rD, int rA, int rB, int32 D);
+	bool gen_x86_store(int mnemo, int rS, int rA, int rB, int32 D);
+	bool gen_x86_lfd(int mnemo, int frD, int rA, int rB, int32 D);
+	bool gen_x86_stfd(int mnemo, int frS, int rA, int rB, int32 D);
+	bool gen_x86_lmw(int mnemo, int rD, int rA, int rB, int32 D);
+	bool gen_x86_stmw(int mnemo, int rS, int rA, int rB, int32 D);
 	bool gen_x86_lvx(int mnemo, int vD, int rA, int rB);
 	bool gen_x86_lvewx(int mnemo, int vD, int rA, int rB);
 	bool gen_x86_stvx(int mnemo, int vS, int rA, int rB);
@@ -44,6 +44,9 @@
 // Define to enable const branches optimization
 #define FOLLOW_CONST_JUMPS 1
 
+// Define to enable lazy evaluation of CR updates
+#define LAZY_CR_EVALUATION 1
+
 #if PPC_ENABLE_JIT
 // FIXME: define ROM areas
 static inline bool is_read_only_memory(uintptr addr)
@@ -144,8 +147,214 @@ powerpc_cpu::call_execute_illegal(powerpc_cpu * cpu, uint32 param1) {
 	cpu->execute_illegal(param1);
 }
 
+/**
+ *		Lazy CR evaluation
+ *
+ *		Record forms and compares don't generate their CR update right
+ *		away. Rather, the last one is kept symbolically and generated
+ *		only when a later instruction could observe the CR field or
+ *		alter its inputs. If a CR field gets overwritten first, the
+ *		pending update is simply dropped.
+ **/
+
+class lazy_cr_update {
+	enum {
+		NONE,
+		RECORD,					// CR0 from GPR rA
+		COMPARE,				// CRF from signed compare of rA and rB
+		COMPARE_IM,				// CRF from signed compare of rA and im
+		COMPARE_LOGICAL,		// CRF from unsigned compare of rA and rB
+		COMPARE_LOGICAL_IM		// CRF from unsigned compare of rA and im
+	};
+	powerpc_jit & dg;
+	int kind, crf, rA, rB;
+	uint32 im;
+
+	void set(int k, int f, int a, int b, uint32 v) {
+		assert(!pending());
+		kind = k; crf = f; rA = a; rB = b; im = v;
+		update_count++;
+#if !LAZY_CR_EVALUATION
+		// Record forms may not have committed rA yet, but T0 holds it
+		if (kind == RECORD) {
+			dg.gen_record_cr0_T0();
+			kind = NONE;
+		}
+		else
+			gen();
+#endif
+	}
+
+public:
+	uint32 update_count;
+	uint32 eliminated_count;
+
+	lazy_cr_update(powerpc_jit & dg_)
+		: dg(dg_), kind(NONE), crf(-1), rA(0), rB(0), im(0), update_count(0), eliminated_count(0)
+		{ }
+
+	bool pending() const	{ return kind != NONE; }
+	int field() const		{ return crf; }
+
+	// Mask of GPRs the pending CR update is computed from
+	uint32 inputs() const {
+		switch (kind) {
+		case RECORD:
+		case COMPARE_IM:
+		case COMPARE_LOGICAL_IM:
+			return 1U << rA;
+		case COMPARE:
+		case COMPARE_LOGICAL:
+			return (1U << rA) | (1U << rB);
+		}
+		return 0;
+	}
+
+	// Record forms, CR0 reflects the result committed to rA
+	void record(int rA)
+		{ set(RECORD, 0, rA, 0, 0); }
+	void compare(int crf, int rA, int rB)
+		{ set(COMPARE, crf, rA, rB, 0); }
+	void compare_im(int crf, int rA, int32 im)
+		{ set(COMPARE_IM, crf, rA, 0, im); }
+	void compare_logical(int crf, int rA, int rB)
+		{ set(COMPARE_LOGICAL, crf, rA, rB, 0); }
+	void compare_logical_im(int crf, int rA, uint32 im)
+		{ set(COMPARE_LOGICAL_IM, crf, rA, 0, im); }
+
+	// Drop the pending CR update, its CR field is overwritten
+	void eliminate() {
+		kind = NONE;
+		eliminated_count++;
+	}
+
+	// Generate the pending CR update, this clobbers T0 and T1
+	void gen() {
+		switch (kind) {
+		case RECORD:
+			dg.gen_load_T0_GPR(rA);
+			dg.gen_record_cr0_T0();
+			break;
+		case COMPARE:
+			dg.gen_load_T0_GPR(rA);
+			dg.gen_load_T1_GPR(rB);
+			dg.gen_compare_T0_T1(crf);
+			break;
+		case COMPARE_IM:
+			dg.gen_load_T0_GPR(rA);
+			dg.gen_compare_T0_im(crf, im);
+			break;
+		case COMPARE_LOGICAL:
+			dg.gen_load_T0_GPR(rA);
+			dg.gen_load_T1_GPR(rB);
+			dg.gen_compare_logical_T0_T1(crf);
+			break;
+		case COMPARE_LOGICAL_IM:
+			dg.gen_load_T0_GPR(rA);
+			dg.gen_compare_logical_T0_im(crf, im);
+			break;
+		}
+		kind = NONE;
+	}
+};
+
+#if LAZY_CR_EVALUATION
+// Returns TRUE if the instruction may read the CR or is not translated
+// inline. Otherwise, also determine the GPRs it writes to, the CR field
+// it entirely overwrites (-1 if none), and whether it can set XER[SO]
+static bool lazy_cr_barrier(int mnemo, uint32 opcode, uint32 & gprs, int & crf, bool & so)
+{
+	const uint32 rA = 1U << rA_field::extract(opcode);
+	const uint32 rD = 1U << rD_field::extract(opcode);
+	gprs = 0;
+	crf = -1;
+	so = false;
+	switch (mnemo) {
+	case PPC_I(LBZ): case PPC_I(LBZU): case PPC_I(LBZUX): case PPC_I(LBZX):
+	case PPC_I(LHA): case PPC_I(LHAU): case PPC_I(LHAUX): case PPC_I(LHAX):
+	case PPC_I(LHZ): case PPC_I(LHZU): case PPC_I(LHZUX): case PPC_I(LHZX):
+	case PPC_I(LWZ): case PPC_I(LWZU): case PPC_I(LWZUX): case PPC_I(LWZX):
+		gprs = rD | rA;
+		break;
+	case PPC_I(STB): case PPC_I(STBU): case PPC_I(STBUX): case PPC_I(STBX):
+	case PPC_I(STH): case PPC_I(STHU): case PPC_I(STHUX): case PPC_I(STHX):
+	case PPC_I(STW): case PPC_I(STWU): case PPC_I(STWUX): case PPC_I(STWX):
+	case PPC_I(LFD): case PPC_I(LFDU): case PPC_I(LFDUX): case PPC_I(LFDX):
+	case PPC_I(LFS): case PPC_I(LFSU): case PPC_I(LFSUX): case PPC_I(LFSX):
+	case PPC_I(STFD): case PPC_I(STFDU): case PPC_I(STFDUX): case PPC_I(STFDX):
+	case PPC_I(STFS): case PPC_I(STFSU): case PPC_I(STFSUX): case PPC_I(STFSX):
+		gprs = rA;
+		break;
+	case PPC_I(B):
+		// Const jumps are followed within the same block
+		if (!FOLLOW_CONST_JUMPS || LK_field::test(opcode))
+			return true;
+		break;
+	case PPC_I(CMP):
+	case PPC_I(CMPI):
+	case PPC_I(CMPL):
+	case PPC_I(CMPLI):
+		crf = crfD_field::extract(opcode);
+		break;
+	case PPC_I(AND): case PPC_I(ANDC): case PPC_I(EQV): case PPC_I(NAND):
+	case PPC_I(NOR): case PPC_I(ORC): case PPC_I(XOR): case PPC_I(OR):
+	case PPC_I(EXTSB): case PPC_I(EXTSH): case PPC_I(CNTLZW):
+	case PPC_I(RLWIMI): case PPC_I(RLWINM): case PPC_I(RLWNM):
+	case PPC_I(SLW): case PPC_I(SRW): case PPC_I(SRAW): case PPC_I(SRAWI):
+		gprs = rA;
+		if (Rc_field::test(opcode))
+			crf = 0;
+		break;
+	case PPC_I(ORI): case PPC_I(ORIS): case PPC_I(XORI): case PPC_I(XORIS):
+		gprs = rA;
+		break;
+	case PPC_I(ANDI): case PPC_I(ANDIS):
+		gprs = rA;
+		crf = 0;
+		break;
+	case PPC_I(ADD): case PPC_I(ADDC): case PPC_I(ADDE):
+	case PPC_I(SUBF): case PPC_I(SUBFC): case PPC_I(SUBFE):
+	case PPC_I(MULLW): case PPC_I(DIVW): case PPC_I(DIVWU): case PPC_I(NEG):
+	case PPC_I(ADDME): case PPC_I(ADDZE): case PPC_I(SUBFME): case PPC_I(SUBFZE):
+		so = OE_field::test(opcode);
+		// fall-through
+	case PPC_I(MULHW): case PPC_I(MULHWU):
+		gprs = rD;
+		if (Rc_field::test(opcode))
+			crf = 0;
+		break;
+	case PPC_I(ADDIC_):
+		crf = 0;
+		// fall-through
+	case PPC_I(ADDI): case PPC_I(ADDIS): case PPC_I(ADDIC):
+	case PPC_I(SUBFIC): case PPC_I(MULLI):
+		gprs = rD;
+		break;
+	case PPC_I(MFSPR):
+		gprs = rD;
+		break;
+	case PPC_I(MTSPR):
+		switch (operand_SPR::get(NULL, opcode)) {
+		case powerpc_registers::SPR_LR:
+		case powerpc_registers::SPR_CTR:
+			break;
+		default:
+			return true;
+		}
+		break;
+	case PPC_I(DCBZ): case PPC_I(DCBA): case PPC_I(DCBF): case PPC_I(DCBI):
+	case PPC_I(DCBST): case PPC_I(DCBT): case PPC_I(DCBTST):
+	case PPC_I(EIEIO): case PPC_I(SYNC):
+		break;
+	default:
+		return true;
+	}
+	return false;
+}
+#endif
+
 powerpc_cpu::block_info *
-powerpc_cpu::compile_block(uint32 entry_point)
+powerpc_cpu::compile_block(uint32 entry_point, bool superblock)
 {
 #if DEBUG
 	bool disasm = false;
@@ -164,11 +373,23 @@ powerpc_cpu::compile_block(uint32 entry_point)
   again:
 	block_info *bi = my_block_cache.new_blockinfo();
 	bi->init(entry_point);
+#if PPC_ENABLE_SUPERBLOCKS
+	bi->superblock = superblock;
+#endif
 	bi->entry_point = dg.gen_start(entry_point);
 
+	// Lazy CR evaluation support variables
+	lazy_cr_update cr_update(dg);
+
 	// Direct block chaining support variables
 	bool use_direct_block_chaining = false;
 
+#if DYNGEN_DIRECT_BLOCK_CHAINING && PPC_ENABLE_SUPERBLOCKS
+	// Superblock support variables
+	uint32 trace_pc = entry_point;		// Start of current basic block
+	int side_exits = 0;
+#endif
+
 	int compile_status;
 	uint32 dpc = entry_point - 4;
 	uint32 min_pc, max_pc;
@@ -185,6 +406,21 @@ powerpc_cpu::compile_block(uint32 entry_point)
 		// Assume we can compile this opcode
 		compile_status = COMPILE_CODE_OK;
 
+#if LAZY_CR_EVALUATION
+		// Generate pending CR update if this instruction depends on it,
+		// or drop it if the CR field is overwritten first
+		if (cr_update.pending()) {
+			uint32 gprs;
+			int crf;
+			bool so;
+			const bool barrier = lazy_cr_barrier(ii->mnemo, opcode, gprs, crf, so);
+			if (!barrier && crf == cr_update.field())
+				cr_update.eliminate();
+			else if (barrier || so || crf >= 0 || (gprs & cr_update.inputs()))
+				cr_update.gen();
+		}
+#endif
+
 #if PPC_FLIGHT_RECORDER
 		if (is_logging()) {
 			typedef void (*func_t)(dyngen_cpu_base, uint32, uint32);
@@ -304,6 +540,11 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			goto do_load;
 		{
 		  do_load:
+			// Use native code generator if available
+			if (dg.gen_load_store(ii->mnemo, rD_field::extract(opcode), rA_field::extract(opcode),
+								  rB_field::extract(opcode), operand_D::get(this, opcode)))
+				break;
+
 			// Extract RZ operand
 			const int rA = rA_field::extract(opcode);
 			if (rA == 0 && !op.mem.do_update)
@@ -423,6 +664,11 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			goto do_store;
 		{
 		  do_store:
+			// Use native code generator if available
+			if (dg.gen_load_store(ii->mnemo, rS_field::extract(opcode), rA_field::extract(opcode),
+								  rB_field::extract(opcode), operand_D::get(this, opcode)))
+				break;
+
 			// Extract RZ operand
 			const int rA = rA_field::extract(opcode);
 			if (rA == 0 && !op.mem.do_update)
@@ -471,6 +717,11 @@ powerpc_cpu::compile_block(uint32 entry_point)
 		case PPC_I(LMW):		// Load Multiple Word
 		case PPC_I(STMW):		// Store Multiple Word
 		{
+			// Use native code generator if available
+			if (dg.gen_load_store(ii->mnemo, rD_field::extract(opcode), rA_field::extract(opcode),
+								  0, operand_D::get(this, opcode)))
+				break;
+
 			const int rA = rA_field::extract(opcode);
 			if (rA == 0)
 				dg.gen_mov_32_T0_im(operand_D::get(this, opcode));
@@ -527,6 +778,32 @@ powerpc_cpu::compile_block(uint32 entry_point)
 #endif
 			const uint32 tpc = ((AA_field::test(opcode) ? 0 : dpc) + operand_BD::get(this, opcode)) & -4;
 			const uint32 npc = dpc + 4;
+#if DYNGEN_DIRECT_BLOCK_CHAINING && PPC_ENABLE_SUPERBLOCKS
+			// Superblocks go on past forward conditional branches, in
+			// the direction the former block took while the loop was
+			// warming up (fall-through if unsure), with a side exit
+			if (superblock && tpc > npc && !LK_field::test(opcode) &&
+				(BO_CONDITIONAL_BRANCH(bo) || BO_DECREMENT_CTR(bo)) &&
+				side_exits < SUPERBLOCK_MAX_SIDE_EXITS) {
+				bool taken = false;
+				block_info *pbi = my_block_cache.find(trace_pc);
+				if (pbi && pbi->end_pc == dpc && pbi->li[0].jmp_pc == tpc && pbi->li[1].jmp_pc == npc) {
+					taken = (dg_get_jmp_target(pbi->li[0].jmp_addr) != pbi->li[0].jmp_resolve_addr &&
+							 dg_get_jmp_target(pbi->li[1].jmp_addr) == pbi->li[1].jmp_resolve_addr);
+				}
+				const uint32 cpc = taken ? tpc : npc;
+				if (direct_chaining_possible(bi->pc, cpc)) {
+					dg.gen_bc_side_exit(bo, BI_field::extract(opcode), !taken, taken ? npc : tpc, (uintptr)bi);
+					side_exits++;
+					trace_pc = cpc;
+					if (dpc > max_pc)
+						max_pc = dpc;
+					dpc = cpc - 4;
+					done_compile = false;
+					break;
+				}
+			}
+#endif
 #if DYNGEN_DIRECT_BLOCK_CHAINING
 			// Use direct block chaining for in-page jumps or jumps to ROM area
 			if (direct_chaining_possible(bi->pc, tpc)) {
@@ -604,28 +881,26 @@ powerpc_cpu::compile_block(uint32 entry_point)
 		}
 		case PPC_I(CMP):		// Compare
 		{
-			dg.gen_load_T0_GPR(rA_field::extract(opcode));
-			dg.gen_load_T1_GPR(rB_field::extract(opcode));
-			dg.gen_compare_T0_T1(crfD_field::extract(opcode));
+			cr_update.compare(crfD_field::extract(opcode),
+							  rA_field::extract(opcode), rB_field::extract(opcode));
 			break;
 		}
 		case PPC_I(CMPI):		// Compare Immediate
 		{
-			dg.gen_load_T0_GPR(rA_field::extract(opcode));
-			dg.gen_compare_T0_im(crfD_field::extract(opcode), operand_SIMM::get(this, opcode));
+			cr_update.compare_im(crfD_field::extract(opcode),
+								 rA_field::extract(opcode), operand_SIMM::get(this, opcode));
 			break;
 		}
 		case PPC_I(CMPL):		// Compare Logical
 		{
-			dg.gen_load_T0_GPR(rA_field::extract(opcode));
-			dg.gen_load_T1_GPR(rB_field::extract(opcode));
-			dg.gen_compare_logical_T0_T1(crfD_field::extract(opcode));
+			cr_update.compare_logical(crfD_field::extract(opcode),
+									  rA_field::extract(opcode), rB_field::extract(opcode));
 			break;
 		}
 		case PPC_I(CMPLI):		// Compare Logical Immediate
 		{
-			dg.gen_load_T0_GPR(rA_field::extract(opcode));
-			dg.gen_compare_logical_T0_im(crfD_field::extract(opcode), operand_UIMM::get(this, opcode));
+			cr_update.compare_logical_im(crfD_field::extract(opcode),
+										 rA_field::extract(opcode), operand_UIMM::get(this, opcode));
 			break;
 		}
 		case PPC_I(CRAND):		// Condition Register AND
@@ -675,7 +950,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			}
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(OR):			// OR
@@ -690,7 +965,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			}
 			dg.gen_store_T0_GPR(rA);
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA);
 			break;
 		}
 		case PPC_I(ORI):		// OR Immediate
@@ -736,7 +1011,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_load_T0_GPR(rS_field::extract(opcode));
 			dg.gen_and_32_T0_im(operand_UIMM::get(this, opcode));
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
-			dg.gen_record_cr0_T0();
+			cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(ANDIS):		// AND Immediate Shifted
@@ -744,7 +1019,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_load_T0_GPR(rS_field::extract(opcode));
 			dg.gen_and_32_T0_im(operand_UIMM_shifted::get(this, opcode));
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
-			dg.gen_record_cr0_T0();
+			cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(EXTSB):		// Extend Sign Byte
@@ -758,7 +1033,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			}
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(NEG):		// Negate
@@ -769,7 +1044,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			else
 				dg.gen_neg_32_T0();
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rD_field::extract(opcode));
 			dg.gen_store_T0_GPR(rD_field::extract(opcode));
 			break;
 		}
@@ -878,7 +1153,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 				}
 			}
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rD_field::extract(opcode));
 			dg.gen_store_T0_GPR(rD_field::extract(opcode));
 			break;
 		}
@@ -894,7 +1169,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 				break;
 			case PPC_I(ADDIC_):
 				dg.gen_addc_T0_im(val);
-				dg.gen_record_cr0_T0();
+				cr_update.record(rD_field::extract(opcode));
 				break;
 			case PPC_I(SUBFIC):
 				dg.gen_subfc_T0_im(val);
@@ -929,7 +1204,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 				}
 			}
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rD_field::extract(opcode));
 			dg.gen_store_T0_GPR(rD_field::extract(opcode));
 			break;
 		}
@@ -972,7 +1247,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_rlwimi_T0_T1(SH, m);
 			dg.gen_store_T0_GPR(rA);
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA);
 			break;
 		}
 		case PPC_I(RLWINM):		// Rotate Left Word Immediate then AND with Mask
@@ -1018,7 +1293,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			}
 			dg.gen_store_T0_GPR(rA);
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA);
 			break;
 		}
 		case PPC_I(RLWNM):		// Rotate Left Word then AND with Mask
@@ -1037,7 +1312,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 				dg.gen_rlwnm_T0_T1(m);
 			dg.gen_store_T0_GPR(rA);
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA);
 			break;
 		}
 		case PPC_I(CNTLZW):		// Count Leading Zeros Word
@@ -1046,7 +1321,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_cntlzw_32_T0();
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(SLW):		// Shift Left Word
@@ -1056,7 +1331,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_slw_T0_T1();
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(SRW):		// Shift Right Word
@@ -1066,7 +1341,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_srw_T0_T1();
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(SRAW):		// Shift Right Algebraic Word
@@ -1076,7 +1351,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_sraw_T0_T1();
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(SRAWI):		// Shift Right Algebraic Word Immediate
@@ -1085,7 +1360,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			dg.gen_sraw_T0_im(SH_field::extract(opcode));
 			dg.gen_store_T0_GPR(rA_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rA_field::extract(opcode));
 			break;
 		}
 		case PPC_I(MULHW):		// Multiply High Word
@@ -1099,7 +1374,7 @@ powerpc_cpu::compile_block(uint32 entry_point)
 				dg.gen_mulhwu_T0_T1();
 			dg.gen_store_T0_GPR(rD_field::extract(opcode));
 			if (Rc_field::test(opcode))
-				dg.gen_record_cr0_T0();
+				cr_update.record(rD_field::extract(opcode));
 			break;
 		}
 		case PPC_I(MULLI):		// Multiply Low Immediate
@@ -1197,6 +1472,11 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			goto do_fp_load;
 		{
 		  do_fp_load:
+			// Use native code generator if available
+			if (dg.gen_load_store(ii->mnemo, frD_field::extract(opcode), rA_field::extract(opcode),
+								  rB_field::extract(opcode), operand_D::get(this, opcode)))
+				break;
+
 			// Extract RZ operand
 			const int rA = rA_field::extract(opcode);
 			if (rA == 0 && !op.mem.do_update)
@@ -1277,6 +1557,11 @@ powerpc_cpu::compile_block(uint32 entry_point)
 			goto do_fp_store;
 		{
 		  do_fp_store:
+			// Use native code generator if available
+			if (dg.gen_load_store(ii->mnemo, frS_field::extract(opcode), rA_field::extract(opcode),
+								  rB_field::extract(opcode), operand_D::get(this, opcode)))
+				break;
+
 			// Extract RZ operand
 			const int rA = rA_field::extract(opcode);
 			if (rA == 0 && !op.mem.do_update)
@@ -1555,14 +1840,19 @@ powerpc_cpu::compile_block(uint32 entry_point)
 		}
 		}
 		if (dg.full_translation_cache()) {
-			// Invalidate cache and start again
-			invalidate_cache();
-			goto again;
+			// Reclaim oldest cache region, start again if code has to move
+			if (reclaim_translation_cache()) {
+				my_block_cache.delete_blockinfo(bi);
+				goto again;
+			}
 		}
 	}
 	// Do nothing if block has special epilogue code generated already
 	assert(compile_status != COMPILE_FAILURE);
 	if (compile_status != COMPILE_EPILOGUE_OK) {
+		// Commit the CR update still pending at the end of the block
+		cr_update.gen();
+
 		// In direct block chaining mode, this code is reached only if
 		// there are pending spcflags, i.e. get out of this block
 		if (!use_direct_block_chaining) {
@@ -1611,6 +1901,14 @@ powerpc_cpu::compile_block(uint32 entry_point)
 	else
 		my_block_cache.add_to_active_list(bi);
 #if PPC_PROFILE_COMPILE_TIME
+	cr_update_count += cr_update.update_count;
+	cr_eliminated_count += cr_update.eliminated_count;
+#if DYNGEN_DIRECT_BLOCK_CHAINING && PPC_ENABLE_SUPERBLOCKS
+	if (superblock) {
+		superblock_count++;
+		side_exit_count += side_exits;
+	}
+#endif
 	compile_time += (clock() - start_time);
 #endif
 	return bi;
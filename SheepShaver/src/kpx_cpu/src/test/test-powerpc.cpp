@@ -30,6 +30,8 @@
 #include <signal.h>
 #include <ctype.h>
 #include <math.h>
+#include <limits.h>
+#include <time.h>
 
 #if defined(__powerpc__) || defined(__ppc__)
 #define NATIVE_POWERPC
@@ -709,6 +711,7 @@ public:
 	~powerpc_test_cpu();
 
 	bool test(void);
+	bool bench_integer_loop(uint32 n_iterations);
 
 	void set_results_file(FILE *fp)
 		{ results_file = fp; }
@@ -2135,6 +2138,45 @@ void powerpc_test_cpu::test_vector_arith(void)
 #endif
 }
 
+// Integer loop benchmark, chains of dependent ALU instructions
+bool powerpc_test_cpu::bench_integer_loop(uint32 n_iterations)
+{
+	static uint32 code[] = {
+		POWERPC_LI(RD, 0),					// li      r3,0
+		POWERPC_LI(RA, 1),					// li      r4,1
+		POWERPC_MTSPR(RB, 9),				// mtctr   r5
+		_XO(31,RD,RD,RA,0,266,0),			// add     r3,r3,r4
+		_D(14,RA,RA,3),						// addi    r4,r4,3
+		_X(31,RD,RC,RA,316,0),				// xor     r6,r3,r4
+		_M(21,RC,RC,3,0,28,0),				// slwi    r6,r6,3
+		_XO(31,RD,RC,RD,0,40,0),			// subf    r3,r6,r3
+		_D(14,RD,RD,7),						// addi    r3,r3,7
+		_D(16,16,0,-24),					// bdnz    .-24
+		POWERPC_BLR
+	};
+	flush_icache_range(code, sizeof(code));
+
+	uint32 r3 = 0, r4 = 1;
+	for (uint32 i = 0; i < n_iterations; i++) {
+		r3 += r4;
+		r4 += 3;
+		r3 = r3 - ((r3 ^ r4) << 3) + 7;
+	}
+
+	set_gpr(RB, n_iterations);
+	clock_t start_time = clock();
+	execute(code);
+	double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	printf("Integer loop: %u iterations in %.3f s (%.1f MIPS)\n",
+		   n_iterations, elapsed, 7.0 * n_iterations / (elapsed * 1e6));
+
+	if (get_gpr(RD) != r3) {
+		printf("ERROR: integer loop result %08x, expected %08x\n", get_gpr(RD), r3);
+		return false;
+	}
+	return true;
+}
+
 // Illegal handler to catch out AltiVec instruction
 #ifdef NATIVE_POWERPC
 static sigjmp_buf env;
@@ -2198,6 +2240,14 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	// Run benchmarks, they don't need a results file
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		const uint32 n_iterations = argc > 2 ? strtoul(argv[2], NULL, 0) : 50000000;
+		bool ok = ppc->bench_integer_loop(n_iterations > 0 ? n_iterations : 1);
+		delete ppc;
+		return !ok;
+	}
+
 	if (argc > 1) {
 		const char *file = argv[1];
 #ifdef NATIVE_POWERPC
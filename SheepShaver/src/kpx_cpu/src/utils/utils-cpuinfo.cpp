@@ -35,7 +35,8 @@ enum {
 	HWCAP_I386_SSSE3		= 1 << 9,
 	HWCAP_I386_SSE4_1		= 1 << 19,
 	HWCAP_I386_SSE4_2		= 1 << 20,
-	HWCAP_I386_ECX_FLAGS	= (HWCAP_I386_SSE3|HWCAP_I386_SSSE3|HWCAP_I386_SSE4_1|HWCAP_I386_SSE4_2)
+	HWCAP_I386_MOVBE		= 1 << 22,
+	HWCAP_I386_ECX_FLAGS	= (HWCAP_I386_SSE3|HWCAP_I386_SSSE3|HWCAP_I386_SSE4_1|HWCAP_I386_SSE4_2|HWCAP_I386_MOVBE)
 };
 
 // Determine x86 CPU features
@@ -130,6 +131,12 @@ bool cpuinfo_check_sse4_2(void)
 	return x86_cpu_features & HWCAP_I386_SSE4_2;
 }
 
+// Check for x86 feature MOVBE
+bool cpuinfo_check_movbe(void)
+{
+	return x86_cpu_features & HWCAP_I386_MOVBE;
+}
+
 // PowerPC CPU features
 static uint32 ppc_cpu_features = 0;
 